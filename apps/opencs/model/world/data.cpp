@@ -888,7 +888,8 @@ int CSMWorld::Data::startLoading (const boost::filesystem::path& path, bool base
     mReader = new ESM::ESMReader;
     mReader->setEncoder (&mEncoder);
     mReader->setIndex(mReaderIndex++);
-    mReader->open (path.string());
+    // Only map the base files; the file being edited must not stay mapped, so that it can be overwritten when saving
+    mReader->open (path.string(), base);
 
     mBase = base;
     mProject = project;
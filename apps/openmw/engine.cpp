@@ -511,7 +511,7 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
 
     window->setStore(mEnvironment.getWorld()->getStore());
     window->initUI();
-    window->renderWorldMap();
+    window->renderWorldMap(mCfgMgr.getCachePath().string());
 
     //Load translation data
     mTranslationDataStorage.setEncoder(mEncoder);
@@ -762,9 +762,9 @@ namespace MWGui
         mLastScrollWindowCoordinates = currentCoordinates;
     }
 
-    void MapWindow::renderGlobalMap(Loading::Listener* loadingListener)
+    void MapWindow::renderGlobalMap(Loading::Listener* loadingListener, const std::string& cacheDir)
     {
-        mGlobalMapRender->render(loadingListener);
+        mGlobalMapRender->render(loadingListener, cacheDir);
         mGlobalMap->setCanvasSize (mGlobalMapRender->getWidth(), mGlobalMapRender->getHeight());
         mGlobalMapImage->setSize(mGlobalMapRender->getWidth(), mGlobalMapRender->getHeight());
 
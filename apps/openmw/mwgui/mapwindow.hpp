@@ -196,7 +196,7 @@ namespace MWGui
 
         virtual void setAlpha(float alpha);
 
-        void renderGlobalMap(Loading::Listener* loadingListener);
+        void renderGlobalMap(Loading::Listener* loadingListener, const std::string& cacheDir);
 
         /// adds the marker to the global map
         /// @param name The ESM::Cell::mName
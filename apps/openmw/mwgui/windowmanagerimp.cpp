@@ -369,9 +369,9 @@ namespace MWGui
         MWBase::Environment::get().getInputManager()->changeInputMode(false);
     }
 
-    void WindowManager::renderWorldMap()
+    void WindowManager::renderWorldMap(const std::string& cacheDir)
     {
-        mMap->renderGlobalMap(mLoadingScreen);
+        mMap->renderGlobalMap(mLoadingScreen, cacheDir);
     }
 
     void WindowManager::setNewGame(bool newgame)
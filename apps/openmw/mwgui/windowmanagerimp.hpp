@@ -128,7 +128,7 @@ namespace MWGui
     void setStore (const MWWorld::ESMStore& store);
 
     void initUI();
-    void renderWorldMap();
+    void renderWorldMap(const std::string& cacheDir);
 
     virtual Loading::Listener* getLoadingScreen();
 
@@ -0,0 +1,115 @@
+#include "actorgrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../mwworld/refdata.hpp"
+
+namespace MWMechanics
+{
+
+    ActorGrid::ActorGrid(float cellSize)
+        : mCellSize(cellSize)
+    {
+    }
+
+    ActorGrid::CellIndex ActorGrid::getCellIndex(const osg::Vec3f &position) const
+    {
+        return std::make_pair(static_cast<int>(std::floor(position.x() / mCellSize)),
+                              static_cast<int>(std::floor(position.y() / mCellSize)));
+    }
+
+    void ActorGrid::insert(const MWWorld::Ptr &ptr)
+    {
+        remove(ptr);
+
+        CellIndex index = getCellIndex(ptr.getRefData().getPosition().asVec3());
+        mGrid[index].push_back(ptr);
+        mActorCells[ptr] = index;
+    }
+
+    void ActorGrid::remove(const MWWorld::Ptr &ptr)
+    {
+        std::map<MWWorld::Ptr, CellIndex>::iterator found = mActorCells.find(ptr);
+        if (found == mActorCells.end())
+            return;
+
+        removeFromCell(ptr, found->second);
+        mActorCells.erase(found);
+    }
+
+    void ActorGrid::removeFromCell(const MWWorld::Ptr &ptr, const CellIndex &index)
+    {
+        Grid::iterator cell = mGrid.find(index);
+        if (cell == mGrid.end())
+            return;
+
+        std::vector<MWWorld::Ptr>& actors = cell->second;
+        std::vector<MWWorld::Ptr>::iterator it = std::find(actors.begin(), actors.end(), ptr);
+        if (it != actors.end())
+        {
+            *it = actors.back();
+            actors.pop_back();
+        }
+
+        if (actors.empty())
+            mGrid.erase(cell);
+    }
+
+    void ActorGrid::update(const MWWorld::Ptr &ptr)
+    {
+        std::map<MWWorld::Ptr, CellIndex>::iterator found = mActorCells.find(ptr);
+        if (found == mActorCells.end())
+        {
+            insert(ptr);
+            return;
+        }
+
+        CellIndex index = getCellIndex(ptr.getRefData().getPosition().asVec3());
+        if (index == found->second)
+            return;
+
+        removeFromCell(ptr, found->second);
+        mGrid[index].push_back(ptr);
+        found->second = index;
+    }
+
+    void ActorGrid::updatePtr(const MWWorld::Ptr &old, const MWWorld::Ptr &ptr)
+    {
+        remove(old);
+        insert(ptr);
+    }
+
+    void ActorGrid::clear()
+    {
+        mGrid.clear();
+        mActorCells.clear();
+    }
+
+    void ActorGrid::query(const osg::Vec3f &position, float radius, std::vector<MWWorld::Ptr> &out) const
+    {
+        const size_t first = out.size();
+        const float sqrRadius = radius * radius;
+
+        CellIndex min = getCellIndex(position - osg::Vec3f(radius, radius, 0));
+        CellIndex max = getCellIndex(position + osg::Vec3f(radius, radius, 0));
+
+        for (int x = min.first; x <= max.first; ++x)
+        {
+            // cells are sorted by x, then y, so each column is one contiguous range
+            Grid::const_iterator cell = mGrid.lower_bound(std::make_pair(x, min.second));
+            for (; cell != mGrid.end() && cell->first.first == x && cell->first.second <= max.second; ++cell)
+            {
+                const std::vector<MWWorld::Ptr>& actors = cell->second;
+                for (std::vector<MWWorld::Ptr>::const_iterator it = actors.begin(); it != actors.end(); ++it)
+                {
+                    if ((it->getRefData().getPosition().asVec3() - position).length2() <= sqrRadius)
+                        out.push_back(*it);
+                }
+            }
+        }
+
+        std::sort(out.begin() + first, out.end());
+    }
+
+}
@@ -0,0 +1,57 @@
+#ifndef GAME_MWMECHANICS_ACTORGRID_H
+#define GAME_MWMECHANICS_ACTORGRID_H
+
+#include <map>
+#include <vector>
+
+#include <osg/Vec3f>
+
+#include "../mwworld/ptr.hpp"
+
+namespace MWMechanics
+{
+    /// @brief Uniform grid over actor positions, used to find the actors near a point without
+    /// testing every actor in the scene.
+    /// @note Actors are sorted into grid cells by the position they had on the last insert() or update()
+    /// call. Callers must update() moving actors for queries to stay accurate.
+    class ActorGrid
+    {
+    public:
+        ActorGrid(float cellSize);
+
+        void insert(const MWWorld::Ptr& ptr);
+
+        /// @note Ignored, if \a ptr is not in the grid.
+        void remove(const MWWorld::Ptr& ptr);
+
+        /// Move the actor to the grid cell containing its current position, if that changed.
+        /// @note Inserts the actor if it is not in the grid yet.
+        void update(const MWWorld::Ptr& ptr);
+
+        /// Replace \a old with \a ptr, use when the actor changed cells.
+        void updatePtr(const MWWorld::Ptr& old, const MWWorld::Ptr& ptr);
+
+        void clear();
+
+        /// Append all actors within \a radius of \a position to \a out, sorted the same way as
+        /// Actors::PtrActorMap so results don't depend on grid layout.
+        void query(const osg::Vec3f& position, float radius, std::vector<MWWorld::Ptr>& out) const;
+
+    private:
+        typedef std::pair<int, int> CellIndex;
+        typedef std::map<CellIndex, std::vector<MWWorld::Ptr> > Grid;
+
+        CellIndex getCellIndex(const osg::Vec3f& position) const;
+
+        void removeFromCell(const MWWorld::Ptr& ptr, const CellIndex& index);
+
+        float mCellSize;
+
+        Grid mGrid;
+
+        /// The grid cell each actor was sorted into
+        std::map<MWWorld::Ptr, CellIndex> mActorCells;
+    };
+}
+
+#endif
@@ -238,8 +238,7 @@ namespace MWMechanics
         calculateRestoration(ptr, duration);
     }
 
-    void Actors::updateHeadTracking(const MWWorld::Ptr& actor, const MWWorld::Ptr& targetActor,
-                                    MWWorld::Ptr& headTrackTarget, float& sqrHeadTrackDistance)
+    float Actors::getMaxHeadTrackDistance(const MWWorld::Ptr& actor) const
     {
         static const float fMaxHeadTrackDistance = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
                 .find("fMaxHeadTrackDistance")->getFloat();
@@ -249,6 +248,13 @@ namespace MWMechanics
         const ESM::Cell* currentCell = actor.getCell()->getCell();
         if (!currentCell->isExterior() && !(currentCell->mData.mFlags & ESM::Cell::QuasiEx))
             maxDistance *= fInteriorHeadTrackMult;
+        return maxDistance;
+    }
+
+    void Actors::updateHeadTracking(const MWWorld::Ptr& actor, const MWWorld::Ptr& targetActor,
+                                    MWWorld::Ptr& headTrackTarget, float& sqrHeadTrackDistance)
+    {
+        float maxDistance = getMaxHeadTrackDistance(actor);
 
         const ESM::Position& actor1Pos = actor.getRefData().getPosition();
         const ESM::Position& actor2Pos = targetActor.getRefData().getPosition();
@@ -902,7 +908,10 @@ namespace MWMechanics
         }
     }
 
-    Actors::Actors() {}
+    Actors::Actors()
+        : mActorGrid(2048.f)
+    {
+    }
 
     Actors::~Actors()
     {
@@ -917,6 +926,7 @@ namespace MWMechanics
         if (!anim)
             return;
         mActors.insert(std::make_pair(ptr, new Actor(ptr, anim)));
+        mActorGrid.insert(ptr);
         if (updateImmediately)
             mActors[ptr]->getCharacterController()->update(0);
     }
@@ -928,6 +938,7 @@ namespace MWMechanics
         {
             delete iter->second;
             mActors.erase(iter);
+            mActorGrid.remove(ptr);
         }
     }
 
@@ -941,6 +952,7 @@ namespace MWMechanics
 
             actor->updatePtr(ptr);
             mActors.insert(std::make_pair(ptr, actor));
+            mActorGrid.updatePtr(old, ptr);
         }
     }
 
@@ -951,6 +963,7 @@ namespace MWMechanics
         {
             if((iter->first.isInCell() && iter->first.getCell()==cellStore) && iter->first != ignore)
             {
+                mActorGrid.remove(iter->first);
                 delete iter->second;
                 mActors.erase(iter++);
             }
@@ -959,8 +972,24 @@ namespace MWMechanics
         }
     }
 
+    void Actors::getActorIds (std::map<int, MWWorld::Ptr>& actorIds)
+    {
+        actorIds.clear();
+        for(PtrActorMap::iterator iter(mActors.begin()); iter != mActors.end(); ++iter)
+        {
+            const MWWorld::Ptr& ptr = iter->first;
+            CreatureStats& stats = ptr.getClass().getCreatureStats(ptr);
+            if (stats.hasActorId() && ptr.getRefData().getCount() > 0)
+                actorIds[stats.getActorId()] = ptr;
+        }
+    }
+
     void Actors::update (float duration, bool paused)
     {
+        // pick up movement since the last update, queries during this frame depend on it
+        for(PtrActorMap::iterator iter(mActors.begin()); iter != mActors.end(); ++iter)
+            mActorGrid.update(iter->first);
+
         if(!paused)
         {
             static float timerUpdateAITargets = 0;
@@ -982,6 +1011,13 @@ namespace MWMechanics
 
             /// \todo move update logic to Actor class where appropriate
 
+            std::vector<MWWorld::Ptr> neighbours;
+
+            // Resolve actor IDs once, so combat AI doesn't search the cells for every target of every actor
+            std::map<int, MWWorld::Ptr> actorIds;
+            if (MWBase::Environment::get().getMechanicsManager()->isAIActive())
+                getActorIds(actorIds);
+
              // AI and magic effects update
             for(PtrActorMap::iterator iter(mActors.begin()); iter != mActors.end(); ++iter)
             {
@@ -1008,11 +1044,18 @@ namespace MWMechanics
                             if (iter->first != player)
                                 adjustCommandedActor(iter->first);
 
-                            for(PtrActorMap::iterator it(mActors.begin()); it != mActors.end(); ++it)
+                            if (iter->first != player) // player is not AI-controlled
                             {
-                                if (it->first == iter->first || iter->first == player) // player is not AI-controlled
-                                    continue;
-                                engageCombat(iter->first, it->first, it->first == player);
+                                // engageCombat() ignores actors further away than this
+                                neighbours.clear();
+                                mActorGrid.query(iter->first.getRefData().getPosition().asVec3(), 7168, neighbours);
+
+                                for(std::vector<MWWorld::Ptr>::iterator it(neighbours.begin()); it != neighbours.end(); ++it)
+                                {
+                                    if (*it == iter->first)
+                                        continue;
+                                    engageCombat(iter->first, *it, *it == player);
+                                }
                             }
                         }
                         if (timerUpdateHeadTrack == 0)
@@ -1020,11 +1063,15 @@ namespace MWMechanics
                             float sqrHeadTrackDistance = std::numeric_limits<float>::max();
                             MWWorld::Ptr headTrackTarget;
 
-                            for(PtrActorMap::iterator it(mActors.begin()); it != mActors.end(); ++it)
+                            neighbours.clear();
+                            mActorGrid.query(iter->first.getRefData().getPosition().asVec3(),
+                                             getMaxHeadTrackDistance(iter->first), neighbours);
+
+                            for(std::vector<MWWorld::Ptr>::iterator it(neighbours.begin()); it != neighbours.end(); ++it)
                             {
-                                if (it->first == iter->first)
+                                if (*it == iter->first)
                                     continue;
-                                updateHeadTracking(iter->first, it->first, headTrackTarget, sqrHeadTrackDistance);
+                                updateHeadTracking(iter->first, *it, headTrackTarget, sqrHeadTrackDistance);
                             }
                             iter->second->getCharacterController()->setHeadTrackTarget(headTrackTarget);
                         }
@@ -1036,7 +1083,7 @@ namespace MWMechanics
                         {
                             CreatureStats &stats = iter->first.getClass().getCreatureStats(iter->first);
                             if (isConscious(iter->first))
-                                stats.getAiSequence().execute(iter->first, *iter->second->getCharacterController(), iter->second->getAiState(), duration);
+                                stats.getAiSequence().execute(iter->first, *iter->second->getCharacterController(), iter->second->getAiState(), duration, &actorIds);
 
                             if (stats.getAiSequence().isInCombat() && !stats.isDead()) hostilesCount++;
                         }
@@ -1141,16 +1188,18 @@ namespace MWMechanics
 
                     bool detected = false;
 
-                    for (PtrActorMap::iterator iter(mActors.begin()); iter != mActors.end(); ++iter)
+                    neighbours.clear();
+                    mActorGrid.query(player.getRefData().getPosition().asVec3(), static_cast<float>(radius), neighbours);
+
+                    for (std::vector<MWWorld::Ptr>::iterator iter(neighbours.begin()); iter != neighbours.end(); ++iter)
                     {
-                        if (iter->first == player)  // not the player
+                        if (*iter == player)  // not the player
                             continue;
 
                         // is the player in range and can they be detected
-                        if ((iter->first.getRefData().getPosition().asVec3() - player.getRefData().getPosition().asVec3()).length2() <= radius*radius
-                            && MWBase::Environment::get().getWorld()->getLOS(player, iter->first))
+                        if (MWBase::Environment::get().getWorld()->getLOS(player, *iter))
                         {
-                            if (MWBase::Environment::get().getMechanicsManager()->awarenessCheck(player, iter->first))
+                            if (MWBase::Environment::get().getMechanicsManager()->awarenessCheck(player, *iter))
                             {
                                 detected = true;
                                 avoidedNotice = false;
@@ -1311,11 +1360,7 @@ namespace MWMechanics
 
     void Actors::getObjectsInRange(const osg::Vec3f& position, float radius, std::vector<MWWorld::Ptr>& out)
     {
-        for (PtrActorMap::iterator iter = mActors.begin(); iter != mActors.end(); ++iter)
-        {
-            if ((iter->first.getRefData().getPosition().asVec3() - position).length2() <= radius*radius)
-                out.push_back(iter->first);
-        }
+        mActorGrid.query(position, radius, out);
     }
 
     std::list<MWWorld::Ptr> Actors::getActorsSidingWith(const MWWorld::Ptr& actor)
@@ -1442,6 +1487,7 @@ namespace MWMechanics
             it->second = NULL;
         }
         mActors.clear();
+        mActorGrid.clear();
         mDeathCount.clear();
     }
 
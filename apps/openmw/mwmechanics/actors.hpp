@@ -8,6 +8,7 @@
 #include <list>
 
 #include "movement.hpp"
+#include "actorgrid.hpp"
 #include "../mwbase/world.hpp"
 
 namespace MWWorld
@@ -43,6 +44,9 @@ namespace MWMechanics
 
             void killDeadActors ();
 
+            /// Get the actors in the scene by actor ID
+            void getActorIds (std::map<int, MWWorld::Ptr>& actorIds);
+
         public:
 
             Actors();
@@ -89,6 +93,9 @@ namespace MWMechanics
             void updateHeadTracking(const MWWorld::Ptr& actor, const MWWorld::Ptr& targetActor,
                                             MWWorld::Ptr& headTrackTarget, float& sqrHeadTrackDistance);
 
+            /// Distance beyond which \a actor does not track other actors with its head
+            float getMaxHeadTrackDistance(const MWWorld::Ptr& actor) const;
+
             void restoreDynamicStats(bool sleep);
             ///< If the player is sleeping, this should be called every hour.
 
@@ -134,6 +141,9 @@ namespace MWMechanics
     private:
         PtrActorMap mActors;
 
+        /// Spatial index over mActors, refreshed at the start of each update
+        ActorGrid mActorGrid;
+
     };
 }
 
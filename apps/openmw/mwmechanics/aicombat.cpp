@@ -515,13 +515,12 @@ namespace MWMechanics
 
     bool AiCombat::doesPathNeedRecalc(ESM::Pathgrid::Point dest, const ESM::Cell *cell)
     {
-        if (!mPathFinder.getPath().empty())
+        // compare with the destination the path was built for, not its last point: a path to a faraway
+        // destination ends at the border of the current cell, see PathFinder::buildPath
+        if (!mPathFinder.getPath().empty() && cell == mPrevCell)
         {
-            osg::Vec3f currPathTarget(PathFinder::MakeOsgVec3(mPathFinder.getPath().back()));
-            osg::Vec3f newPathTarget = PathFinder::MakeOsgVec3(dest);
-            float dist = (newPathTarget - currPathTarget).length();
             float targetPosThreshold = (cell->isExterior()) ? 300.0f : 100.0f;
-            return dist > targetPosThreshold;
+            return distance(mPrevDest, dest) > targetPosThreshold;
         }
         else
         {
@@ -535,10 +534,13 @@ namespace MWMechanics
         ESM::Pathgrid::Point newPathTarget = PathFinder::MakePathgridPoint(target.getRefData().getPosition());
 
         //construct new path only if target has moved away more than on [targetPosThreshold]
-        if (doesPathNeedRecalc(newPathTarget, actor.getCell()->getCell()))
+        const ESM::Cell* cell = actor.getCell()->getCell();
+        if (doesPathNeedRecalc(newPathTarget, cell))
         {
             ESM::Pathgrid::Point start(PathFinder::MakePathgridPoint(actor.getRefData().getPosition()));
             mPathFinder.buildSyncedPath(start, newPathTarget, actor.getCell(), false);
+            mPrevDest = newPathTarget;
+            mPrevCell = cell;
         }
     }
 
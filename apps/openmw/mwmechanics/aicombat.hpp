@@ -51,6 +51,8 @@ namespace MWMechanics
             ///Returns target ID
             MWWorld::Ptr getTarget() const;
 
+            int getTargetActorId() const { return mTargetActorId; }
+
             virtual void writeState(ESM::AiSequence::AiSequence &sequence) const;
 
             virtual bool canCancel() const { return false; }
@@ -45,7 +45,7 @@ bool MWMechanics::AiPackage::shouldCancelPreviousAi() const
     return true;
 }
 
-MWMechanics::AiPackage::AiPackage() : mTimer(0.26f) { //mTimer starts at .26 to force initial pathbuild
+MWMechanics::AiPackage::AiPackage() : mTimer(0.26f), mPrevCell(NULL) { //mTimer starts at .26 to force initial pathbuild
 
 }
 
@@ -77,6 +77,7 @@ bool MWMechanics::AiPackage::pathTo(const MWWorld::Ptr& actor, ESM::Pathgrid::Po
         if (doesPathNeedRecalc(dest, cell)) { //Only rebuild path if it's moved
             mPathFinder.buildSyncedPath(pos.pos, dest, actor.getCell(), true); //Rebuild path, in case the target has moved
             mPrevDest = dest;
+            mPrevCell = cell;
         }
 
         if(!mPathFinder.getPath().empty()) //Path has points in it
@@ -130,7 +131,8 @@ void MWMechanics::AiPackage::evadeObstacles(const MWWorld::Ptr& actor, float dur
 
 bool MWMechanics::AiPackage::doesPathNeedRecalc(ESM::Pathgrid::Point dest, const ESM::Cell *cell)
 {
-    return distance(mPrevDest, dest) > 10;
+    // paths into other cells only lead up to the next cell, see PathFinder::buildPath
+    return distance(mPrevDest, dest) > 10 || cell != mPrevCell;
 }
 
 bool MWMechanics::AiPackage::isTargetMagicallyHidden(const MWWorld::Ptr& target)
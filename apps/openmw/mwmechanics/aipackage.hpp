@@ -104,6 +104,7 @@ namespace MWMechanics
             float mTimer;
 
             ESM::Pathgrid::Point mPrevDest;
+            const ESM::Cell* mPrevCell; ///< The cell the path was built in
 
         private:
             bool isNearInactiveCell(const ESM::Position& actorPos);
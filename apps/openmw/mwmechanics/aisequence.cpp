@@ -147,7 +147,8 @@ bool AiSequence::isPackageDone() const
     return mDone;
 }
 
-void AiSequence::execute (const MWWorld::Ptr& actor, CharacterController& characterController, AiState& state, float duration)
+void AiSequence::execute (const MWWorld::Ptr& actor, CharacterController& characterController, AiState& state, float duration,
+                          const std::map<int, MWWorld::Ptr>* actorIds)
 {
     if(actor != getPlayer())
     {
@@ -172,7 +173,16 @@ void AiSequence::execute (const MWWorld::Ptr& actor, CharacterController& charac
             {
                 if ((*it)->getTypeId() != AiPackage::TypeIdCombat) break;
 
-                MWWorld::Ptr target = static_cast<const AiCombat *>(*it)->getTarget();
+                MWWorld::Ptr target;
+                if (actorIds)
+                {
+                    std::map<int, MWWorld::Ptr>::const_iterator found = actorIds->find(static_cast<const AiCombat *>(*it)->getTargetActorId());
+                    if (found != actorIds->end() && found->second.getRefData().getCount() > 0)
+                        target = found->second;
+                }
+                // not in the scene when the map was made, e.g. summoned this frame
+                if (target.isEmpty())
+                    target = static_cast<const AiCombat *>(*it)->getTarget();
 
                 // target disappeared (e.g. summoned creatures)
                 if (target.isEmpty())
@@ -2,6 +2,7 @@
 #define GAME_MWMECHANICS_AISEQUENCE_H
 
 #include <list>
+#include <map>
 
 #include <components/esm/loadnpc.hpp>
 //#include "aistate.hpp"
@@ -96,7 +97,10 @@ namespace MWMechanics
             void stopPursuit();
 
             /// Execute current package, switching if needed.
-            void execute (const MWWorld::Ptr& actor, CharacterController& characterController, MWMechanics::AiState& state, float duration);
+            /// \param actorIds Actors in the scene by actor ID, to look up combat targets in instead of searching
+            /// the active cells with World::searchPtrViaActorId. NULL to search.
+            void execute (const MWWorld::Ptr& actor, CharacterController& characterController, MWMechanics::AiState& state, float duration,
+                          const std::map<int, MWWorld::Ptr>* actorIds = NULL);
 
             /// Simulate the passing of time using the currently active AI package
             void fastForward(const MWWorld::Ptr &actor, AiState &state);
@@ -0,0 +1,215 @@
+#include "cellgraph.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+
+#include <components/esm/loadland.hpp>
+
+#include "../mwworld/store.hpp"
+
+namespace
+{
+    // How close to the border the pathgrid points used to cross it must be
+    static const int sBorderWidth = 2048;
+
+    // Pathgrid points further apart than this are not considered to be linked
+    static const float sMaxPortalDistance = 2048.f;
+
+    // Stop searching after this many steps, so that unreachable goals don't make us visit the whole world
+    static const size_t sMaxSearchedNodes = 1024;
+
+    float distanceSquared(const ESM::Pathgrid::Point& a, const ESM::Pathgrid::Point& b)
+    {
+        float x = static_cast<float>(a.mX - b.mX);
+        float y = static_cast<float>(a.mY - b.mY);
+        float z = static_cast<float>(a.mZ - b.mZ);
+        return x * x + y * y + z * z;
+    }
+
+    ESM::Pathgrid::Point toWorld(const ESM::Pathgrid::Point& point, int cellX, int cellY)
+    {
+        return ESM::Pathgrid::Point(point.mX + cellX * ESM::Land::REAL_SIZE, point.mY + cellY * ESM::Land::REAL_SIZE, point.mZ);
+    }
+
+    // Is the point (in local co-ordinates) near the border of its cell in the direction (dx, dy)?
+    bool isNearBorder(const ESM::Pathgrid::Point& point, int dx, int dy)
+    {
+        if (dx > 0)
+            return point.mX >= ESM::Land::REAL_SIZE - sBorderWidth;
+        if (dx < 0)
+            return point.mX <= sBorderWidth;
+        if (dy > 0)
+            return point.mY >= ESM::Land::REAL_SIZE - sBorderWidth;
+        return point.mY <= sBorderWidth;
+    }
+}
+
+namespace MWMechanics
+{
+
+    CellGraph::CellGraph(const MWWorld::Store<ESM::Pathgrid>& pathgrids)
+        : mPathgrids(pathgrids)
+    {
+    }
+
+    const MWWorld::Store<ESM::Pathgrid>& CellGraph::getPathgrids() const
+    {
+        return mPathgrids;
+    }
+
+    const PathgridGraph* CellGraph::getGraph(const CellIndex& cell)
+    {
+        std::map<CellIndex, PathgridGraph>::const_iterator found = mGraphs.find(cell);
+        if (found != mGraphs.end())
+            return &found->second;
+
+        const ESM::Pathgrid* pathgrid = mPathgrids.search(cell.first, cell.second);
+        if (!pathgrid || pathgrid->mPoints.empty())
+            return NULL;
+
+        PathgridGraph& graph = mGraphs[cell];
+        graph.load(pathgrid);
+        return &graph;
+    }
+
+    const std::vector<CellGraph::Portal>& CellGraph::getPortals(const CellIndex& cell)
+    {
+        std::map<CellIndex, std::vector<Portal> >::const_iterator found = mPortals.find(cell);
+        if (found != mPortals.end())
+            return found->second;
+
+        std::vector<Portal>& portals = mPortals[cell];
+
+        const PathgridGraph* graph = getGraph(cell);
+        if (!graph)
+            return portals;
+        const ESM::Pathgrid* pathgrid = mPathgrids.search(cell.first, cell.second);
+
+        static const int directions[4][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+        for (int i=0; i<4; ++i)
+        {
+            const int dx = directions[i][0];
+            const int dy = directions[i][1];
+            const CellIndex neighbourCell (cell.first + dx, cell.second + dy);
+            const PathgridGraph* neighbourGraph = getGraph(neighbourCell);
+            if (!neighbourGraph)
+                continue;
+            const ESM::Pathgrid* neighbour = mPathgrids.search(neighbourCell.first, neighbourCell.second);
+
+            // The closest pair of points on either side of the border, for every pair of parts of the pathgrids
+            // that are not connected to each other. E.g. a road and a fenced off yard can both lead across the
+            // border, but a route arriving on the road can only continue on the road.
+            const size_t firstPortal = portals.size();
+            std::vector<float> distances;
+            for (int from = 0; from < static_cast<int>(pathgrid->mPoints.size()); ++from)
+            {
+                if (!isNearBorder(pathgrid->mPoints[from], dx, dy))
+                    continue;
+                ESM::Pathgrid::Point fromWorld = toWorld(pathgrid->mPoints[from], cell.first, cell.second);
+
+                for (int to = 0; to < static_cast<int>(neighbour->mPoints.size()); ++to)
+                {
+                    if (!isNearBorder(neighbour->mPoints[to], -dx, -dy))
+                        continue;
+                    ESM::Pathgrid::Point toWorldPoint = toWorld(neighbour->mPoints[to], neighbourCell.first, neighbourCell.second);
+
+                    float distance = distanceSquared(fromWorld, toWorldPoint);
+                    if (distance >= sMaxPortalDistance * sMaxPortalDistance)
+                        continue;
+
+                    size_t j = firstPortal;
+                    for (; j < portals.size(); ++j)
+                    {
+                        if (graph->isPointConnected(portals[j].mFromIndex, from)
+                                && neighbourGraph->isPointConnected(portals[j].mToIndex, to))
+                            break;
+                    }
+
+                    if (j == portals.size())
+                    {
+                        portals.push_back(Portal());
+                        distances.push_back(distance);
+                    }
+                    else if (distance >= distances[j - firstPortal])
+                        continue;
+
+                    Portal& portal = portals[j];
+                    portal.mCellX = neighbourCell.first;
+                    portal.mCellY = neighbourCell.second;
+                    portal.mFromIndex = from;
+                    portal.mToIndex = to;
+                    portal.mFrom = fromWorld;
+                    portal.mTo = toWorldPoint;
+                    distances[j - firstPortal] = distance;
+                }
+            }
+        }
+
+        return portals;
+    }
+
+    bool CellGraph::findRoute(int startX, int startY, int startPoint, int goalX, int goalY, int goalPoint, std::vector<Portal>& route)
+    {
+        route.clear();
+
+        // A* over the places where a route enters a cell, as the cell and the pathgrid point it was entered at.
+        // Every cell crossed costs the same.
+        typedef std::pair<CellIndex, int> Node;
+        typedef std::pair<int, Node> OpenNode; // estimated cost, node
+        std::priority_queue<OpenNode, std::vector<OpenNode>, std::greater<OpenNode> > open;
+        std::map<Node, int> cost;
+        std::map<Node, std::pair<Node, Portal> > cameFrom; // the previous node, and how we got here
+
+        const Node start (CellIndex(startX, startY), startPoint);
+        cost[start] = 0;
+        open.push(OpenNode(std::abs(goalX - startX) + std::abs(goalY - startY), start));
+
+        size_t searchedNodes = 0;
+        while (!open.empty() && searchedNodes < sMaxSearchedNodes)
+        {
+            const Node current = open.top().second;
+            const CellIndex& cell = current.first;
+            const int estimate = open.top().first;
+            open.pop();
+
+            const int currentCost = cost[current];
+            if (estimate > currentCost + std::abs(goalX - cell.first) + std::abs(goalY - cell.second))
+                continue; // outdated entry, the node was reached more cheaply since
+
+            const PathgridGraph* graph = getGraph(cell);
+            if (!graph)
+                continue;
+
+            if (cell == CellIndex(goalX, goalY) && (goalPoint < 0 || graph->isPointConnected(current.second, goalPoint)))
+            {
+                for (Node node = current; node != start; node = cameFrom[node].first)
+                    route.push_back(cameFrom[node].second);
+                std::reverse(route.begin(), route.end());
+                return true;
+            }
+
+            ++searchedNodes;
+
+            const std::vector<Portal>& portals = getPortals(cell);
+            for (std::vector<Portal>::const_iterator it = portals.begin(); it != portals.end(); ++it)
+            {
+                if (!graph->isPointConnected(current.second, it->mFromIndex))
+                    continue;
+
+                const Node next (CellIndex(it->mCellX, it->mCellY), it->mToIndex);
+                std::map<Node, int>::iterator found = cost.find(next);
+                if (found != cost.end() && found->second <= currentCost + 1)
+                    continue;
+
+                cost[next] = currentCost + 1;
+                cameFrom[next] = std::make_pair(current, *it);
+                open.push(OpenNode(currentCost + 1 + std::abs(goalX - it->mCellX) + std::abs(goalY - it->mCellY), next));
+            }
+        }
+
+        return false;
+    }
+
+}
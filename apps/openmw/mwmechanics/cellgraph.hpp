@@ -0,0 +1,65 @@
+#ifndef GAME_MWMECHANICS_CELLGRAPH_H
+#define GAME_MWMECHANICS_CELLGRAPH_H
+
+#include <map>
+#include <vector>
+
+#include <components/esm/loadpgrd.hpp>
+
+#include "pathgrid.hpp"
+
+namespace MWWorld
+{
+    template <class T>
+    class Store;
+}
+
+namespace MWMechanics
+{
+    /// @brief Coarse graph of the exterior cells that have a pathgrid, linked where the pathgrids of neighbouring
+    /// cells come close to their shared border. Long routes are planned cell by cell on this graph, so that the
+    /// pathgrid search of each cell only has to find the way to the next border.
+    /// @note A border may be crossed in several places, one for every pair of connected parts of the pathgrids
+    /// on either side. A route only continues through a cell from a portal that is connected to where it entered.
+    /// @note The links of a cell are worked out the first time a search reaches the cell.
+    class CellGraph
+    {
+    public:
+        /// Where to cross from one cell into a neighbouring one.
+        struct Portal
+        {
+            int mCellX;
+            int mCellY;
+            int mFromIndex; ///< Index of mFrom in the pathgrid of the cell we are leaving
+            int mToIndex; ///< Index of mTo in the pathgrid of the cell (mCellX, mCellY)
+            ESM::Pathgrid::Point mFrom; ///< Pathgrid point of the cell we are leaving, in world co-ordinates
+            ESM::Pathgrid::Point mTo; ///< Pathgrid point of the cell (mCellX, mCellY), in world co-ordinates
+        };
+
+        CellGraph(const MWWorld::Store<ESM::Pathgrid>& pathgrids);
+
+        const MWWorld::Store<ESM::Pathgrid>& getPathgrids() const;
+
+        /// Find a route from a pathgrid point of the exterior cell (startX, startY) to a pathgrid point of (goalX, goalY).
+        /// @param startPoint Pathgrid point index in the start cell
+        /// @param goalPoint Pathgrid point index in the goal cell, or -1 to accept any point of the goal cell
+        /// @param route Set to the portals to pass through, in order. Empty if the goal can be reached without leaving the start cell.
+        /// @return Was a route found? Gives up on goals that are far away or can't be reached.
+        bool findRoute(int startX, int startY, int startPoint, int goalX, int goalY, int goalPoint, std::vector<Portal>& route);
+
+    private:
+        typedef std::pair<int, int> CellIndex;
+
+        /// @return NULL if the cell has no pathgrid
+        const PathgridGraph* getGraph(const CellIndex& cell);
+
+        const std::vector<Portal>& getPortals(const CellIndex& cell);
+
+        const MWWorld::Store<ESM::Pathgrid>& mPathgrids;
+
+        std::map<CellIndex, PathgridGraph> mGraphs;
+        std::map<CellIndex, std::vector<Portal> > mPortals;
+    };
+}
+
+#endif
@@ -600,6 +600,11 @@ namespace MWMechanics
         return mActorId!=-1 && id==mActorId;
     }
 
+    bool CreatureStats::hasActorId() const
+    {
+        return mActorId!=-1;
+    }
+
     void CreatureStats::cleanup()
     {
         sActorId = 0;
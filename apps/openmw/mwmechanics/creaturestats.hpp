@@ -270,6 +270,9 @@ namespace MWMechanics
         ///< Check if \a id matches the actor ID of *this (if the actor does not have an ID
         /// assigned this function will return false).
 
+        bool hasActorId() const;
+        ///< Has an actor ID been generated for this actor?
+
         static void cleanup();
     };
 }
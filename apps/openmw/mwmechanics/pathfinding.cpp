@@ -1,5 +1,7 @@
 #include "pathfinding.hpp"
+#include <cstdlib>
 #include <limits>
+#include <memory>
 
 #include "../mwbase/world.hpp"
 #include "../mwbase/environment.hpp"
@@ -7,6 +9,7 @@
 #include "../mwworld/esmstore.hpp"
 #include "../mwworld/cellstore.hpp"
 #include "coordinateconverter.hpp"
+#include "cellgraph.hpp"
 
 namespace
 {
@@ -90,6 +93,20 @@ namespace
             (closestReachableIndex, closestReachableIndex == closestIndex);
     }
 
+    // Paths are only built on the main thread (the AI think phase doesn't), so they can share the search buffers
+    MWMechanics::AStarScratch sAStarScratch;
+    MWMechanics::PathgridPath sPathgridPath;
+    std::vector<MWMechanics::CellGraph::Portal> sCellRoute;
+
+    MWMechanics::CellGraph& getCellGraph()
+    {
+        static std::auto_ptr<MWMechanics::CellGraph> sCellGraph;
+
+        const MWWorld::Store<ESM::Pathgrid>& pathgrids = MWBase::Environment::get().getWorld()->getStore().get<ESM::Pathgrid>();
+        if (!sCellGraph.get() || &sCellGraph->getPathgrids() != &pathgrids)
+            sCellGraph.reset(new MWMechanics::CellGraph(pathgrids));
+        return *sCellGraph;
+    }
 }
 
 namespace MWMechanics
@@ -210,7 +227,37 @@ namespace MWMechanics
         osg::Vec3f startPointInLocalCoords(converter.toLocalVec3(startPoint));
         int startNode = getClosestPoint(mPathgrid, startPointInLocalCoords);
 
-        osg::Vec3f endPointInLocalCoords(converter.toLocalVec3(endPoint));
+        // If the destination is beyond the neighbouring exterior cells, plan the route cell by cell and only path to
+        // where the route leaves this cell. The rest of the way is planned once the actor has reached the next cell.
+        // Closer destinations are left to the pathgrid of this cell, same as always.
+        ESM::Pathgrid::Point target = endPoint;
+        bool leavesCell = false;
+        if(mCell->getCell()->isExterior())
+        {
+            const int cellX = mCell->getCell()->getGridX();
+            const int cellY = mCell->getCell()->getGridY();
+            int targetCellX, targetCellY;
+            MWBase::Environment::get().getWorld()->positionToIndex(static_cast<float>(endPoint.mX),
+                                                                   static_cast<float>(endPoint.mY), targetCellX, targetCellY);
+            if(std::abs(targetCellX - cellX) > 1 || std::abs(targetCellY - cellY) > 1)
+            {
+                const MWWorld::ESMStore& store = MWBase::Environment::get().getWorld()->getStore();
+                int goalNode = -1;
+                const ESM::Cell* targetCell = store.get<ESM::Cell>().search(targetCellX, targetCellY);
+                const ESM::Pathgrid* targetPathgrid = targetCell ? store.get<ESM::Pathgrid>().search(*targetCell) : NULL;
+                if(targetPathgrid && !targetPathgrid->mPoints.empty())
+                    goalNode = getClosestPoint(targetPathgrid, CoordinateConverter(targetCell).toLocalVec3(endPoint));
+
+                if(getCellGraph().findRoute(cellX, cellY, startNode, targetCellX, targetCellY, goalNode, sCellRoute)
+                        && !sCellRoute.empty())
+                {
+                    target = sCellRoute.front().mFrom;
+                    leavesCell = true;
+                }
+            }
+        }
+
+        osg::Vec3f endPointInLocalCoords(converter.toLocalVec3(target));
         std::pair<int, bool> endNode = getClosestReachablePoint(mPathgrid, cell,
             endPointInLocalCoords,
                 startNode);
@@ -222,7 +269,9 @@ namespace MWMechanics
         float startTo1stNodeLength2 = distanceSquared(mPathgrid->mPoints[startNode], startPointInLocalCoords);
         if ((startToEndLength2 < startTo1stNodeLength2) || (startToEndLength2 < endTolastNodeLength2))
         {
-            mPath.push_back(endPoint);
+            mPath.push_back(target);
+            if(leavesCell)
+                mPath.push_back(sCellRoute.front().mTo);
             return;
         }
 
@@ -239,12 +288,14 @@ namespace MWMechanics
         }
         else
         {
-            mPath = mCell->aStarSearch(startNode, endNode.first);
+            mCell->aStarSearch(startNode, endNode.first, sPathgridPath, sAStarScratch);
 
             // convert supplied path to world co-ordinates
-            for (std::list<ESM::Pathgrid::Point>::iterator iter(mPath.begin()); iter != mPath.end(); ++iter)
+            for (PathgridPath::const_iterator iter(sPathgridPath.begin()); iter != sPathgridPath.end(); ++iter)
             {
-                converter.toWorld(*iter);
+                ESM::Pathgrid::Point point(mPathgrid->mPoints[*iter]);
+                converter.toWorld(point);
+                mPath.push_back(point);
             }
         }
 
@@ -260,8 +311,11 @@ namespace MWMechanics
         // unreachable pathgrid point.
         //
         // The AI routines will have to deal with such situations.
+        //
+        // When leaving the cell, the target is the pathgrid point at the border,
+        // so continue to the first pathgrid point of the next cell instead.
         if(endNode.second)
-            mPath.push_back(endPoint);
+            mPath.push_back(leavesCell ? sCellRoute.front().mTo : endPoint);
     }
 
     float PathFinder::getZAngleToNext(float x, float y) const
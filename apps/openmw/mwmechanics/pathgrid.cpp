@@ -1,10 +1,7 @@
 #include "pathgrid.hpp"
 
-#include "../mwbase/world.hpp"
-#include "../mwbase/environment.hpp"
-
-#include "../mwworld/cellstore.hpp"
-#include "../mwworld/esmstore.hpp"
+#include <algorithm>
+#include <cstdlib>
 
 namespace
 {
@@ -49,10 +46,170 @@ namespace
 
 namespace MWMechanics
 {
+    AStarScratch::AStarScratch()
+        : mCurrentGeneration(0)
+        , mNextOrder(0)
+    {
+    }
+
+    void AStarScratch::reset(size_t graphSize)
+    {
+        if (mGeneration.size() < graphSize)
+        {
+            mGeneration.resize(graphSize, 0);
+            mGScore.resize(graphSize);
+            mFScore.resize(graphSize);
+            mParent.resize(graphSize);
+            mHeapPos.resize(graphSize);
+            mOrder.resize(graphSize);
+        }
+
+        // Points of previous searches are told apart by their generation, so nothing needs to be cleared
+        ++mCurrentGeneration;
+        if (mCurrentGeneration == 0)
+        {
+            std::fill(mGeneration.begin(), mGeneration.end(), 0);
+            mCurrentGeneration = 1;
+        }
+
+        mHeap.clear();
+        mNextOrder = 0;
+    }
+
+    bool AStarScratch::isOpen(int point) const
+    {
+        return mGeneration[point] == mCurrentGeneration && mHeapPos[point] != -1;
+    }
+
+    bool AStarScratch::isClosed(int point) const
+    {
+        return mGeneration[point] == mCurrentGeneration && mHeapPos[point] == -1;
+    }
+
+    void AStarScratch::open(int point, float gScore, float fScore, int parent)
+    {
+        mGScore[point] = gScore;
+        mFScore[point] = fScore;
+        mParent[point] = parent;
+
+        if (isOpen(point))
+        {
+            // costs only ever decrease
+            siftUp(mHeapPos[point]);
+            return;
+        }
+
+        mGeneration[point] = mCurrentGeneration;
+        mOrder[point] = mNextOrder++;
+        mHeapPos[point] = static_cast<int>(mHeap.size());
+        mHeap.push_back(point);
+        siftUp(mHeap.size() - 1);
+    }
+
+    int AStarScratch::closeBest()
+    {
+        int best = mHeap.front();
+        mHeap.front() = mHeap.back();
+        mHeapPos[mHeap.front()] = 0;
+        mHeap.pop_back();
+        if (!mHeap.empty())
+            siftDown(0);
+
+        mHeapPos[best] = -1;
+        return best;
+    }
+
+    bool AStarScratch::less(int a, int b) const
+    {
+        if (mFScore[a] != mFScore[b])
+            return mFScore[a] < mFScore[b];
+        return mOrder[a] < mOrder[b];
+    }
+
+    void AStarScratch::siftUp(size_t pos)
+    {
+        int point = mHeap[pos];
+        while (pos > 0)
+        {
+            size_t parent = (pos - 1) / 2;
+            if (!less(point, mHeap[parent]))
+                break;
+            mHeap[pos] = mHeap[parent];
+            mHeapPos[mHeap[pos]] = static_cast<int>(pos);
+            pos = parent;
+        }
+        mHeap[pos] = point;
+        mHeapPos[point] = static_cast<int>(pos);
+    }
+
+    void AStarScratch::siftDown(size_t pos)
+    {
+        int point = mHeap[pos];
+        const size_t size = mHeap.size();
+        while (true)
+        {
+            size_t child = pos * 2 + 1;
+            if (child >= size)
+                break;
+            if (child + 1 < size && less(mHeap[child + 1], mHeap[child]))
+                ++child;
+            if (!less(mHeap[child], point))
+                break;
+            mHeap[pos] = mHeap[child];
+            mHeapPos[mHeap[pos]] = static_cast<int>(pos);
+            pos = child;
+        }
+        mHeap[pos] = point;
+        mHeapPos[point] = static_cast<int>(pos);
+    }
+
+    PathgridPathCache::PathgridPathCache()
+        : mNextEntry(0)
+    {
+    }
+
+    bool PathgridPathCache::find(int start, int goal, PathgridPath& path) const
+    {
+        for (std::vector<Entry>::const_iterator it = mEntries.begin(); it != mEntries.end(); ++it)
+        {
+            if (it->mGoal != goal)
+                continue;
+
+            PathgridPath::const_iterator found = std::find(it->mPath.begin(), it->mPath.end(), start);
+            if (found != it->mPath.end())
+            {
+                path.assign(found, it->mPath.end());
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void PathgridPathCache::insert(int goal, const PathgridPath& path)
+    {
+        static const size_t maxEntries = 16;
+
+        Entry entry;
+        entry.mGoal = goal;
+        entry.mPath = path;
+
+        if (mEntries.size() < maxEntries)
+            mEntries.push_back(entry);
+        else
+        {
+            mEntries[mNextEntry] = entry;
+            mNextEntry = (mNextEntry + 1) % maxEntries;
+        }
+    }
+
+    void PathgridPathCache::clear()
+    {
+        mEntries.clear();
+        mNextEntry = 0;
+    }
+
     PathgridGraph::PathgridGraph()
-        : mCell(NULL)
-        , mPathgrid(NULL)
-        , mIsExterior(0)
+        : mPathgrid(NULL)
         , mGraph(0)
         , mIsGraphConstructed(false)
         , mSCCId(0)
@@ -96,17 +253,12 @@ namespace MWMechanics
      *    +---------------->
      *      high cost
      */
-    bool PathgridGraph::load(const MWWorld::CellStore *cell)
+    bool PathgridGraph::load(const ESM::Pathgrid *pathgrid)
     {
-        if(!cell)
-            return false;
-
         if(mIsGraphConstructed)
             return true;
 
-        mCell = cell->getCell();
-        mIsExterior = cell->getCell()->isExterior();
-        mPathgrid = MWBase::Environment::get().getWorld()->getStore().get<ESM::Pathgrid>().search(*cell->getCell());
+        mPathgrid = pathgrid;
         if(!mPathgrid)
             return false;
 
@@ -222,106 +374,76 @@ namespace MWMechanics
      * Uses mGraph which has pre-computed costs for allowed edges.  It is assumed
      * that mGraph is already constructed.
      *
-     * Should be possible to make this MT safe.
+     * MT safe, as long as every thread uses its own scratch.
      *
-     * Returns path which may be empty.  path contains pathgrid points in local
-     * cell co-ordinates (indoors) or world co-ordinates (external).
+     * Returns false if there is no path.  path contains the pathgrid point
+     * indexes; the caller converts them to local cell co-ordinates (indoors)
+     * or world co-ordinates (external) as needed.
      *
      * Input params:
      *   start, goal - pathgrid point indexes (for this cell)
      *
-     * Variables:
-     *   openset - point indexes to be traversed, lowest cost at the front
-     *   closedset - point indexes already traversed
-     *   gScore - past accumulated costs vector indexed by point index
-     *   fScore - future estimated costs vector indexed by point index
-     *
-     * TODO: An intersting exercise might be to cache the paths created for a
-     *       start/goal pair.  To cache the results the paths need to be in
-     *       pathgrid points form (currently they are converted to world
-     *       co-ordinates).  Essentially trading speed w/ memory.
+     * Variables (in scratch):
+     *   mHeap - open set, point indexes to be traversed, lowest cost at the front
+     *   mHeapPos - position in the open set, or -1 for points already traversed
+     *   mGScore - past accumulated costs indexed by point index
+     *   mFScore - future estimated costs indexed by point index
      */
-    std::list<ESM::Pathgrid::Point> PathgridGraph::aStarSearch(const int start,
-                                                               const int goal) const
+    bool PathgridGraph::aStarSearch(const int start, const int goal, PathgridPath& path,
+                                    AStarScratch& scratch) const
     {
-        std::list<ESM::Pathgrid::Point> path;
+        path.clear();
         if(!isPointConnected(start, goal))
         {
-            return path; // there is no path, return an empty path
+            return false; // there is no path
         }
 
-        int graphSize = static_cast<int> (mGraph.size());
-        std::vector<float> gScore (graphSize, -1);
-        std::vector<float> fScore (graphSize, -1);
-        std::vector<int> graphParent (graphSize, -1);
-
-        // gScore & fScore keep costs for each pathgrid point in mPoints
-        gScore[start] = 0;
-        fScore[start] = costAStar(mPathgrid->mPoints[start], mPathgrid->mPoints[goal]);
-
-        std::list<int> openset;
-        std::list<int> closedset;
-        openset.push_back(start);
+        scratch.reset(mGraph.size());
+        scratch.open(start, 0, costAStar(mPathgrid->mPoints[start], mPathgrid->mPoints[goal]), -1);
 
-        int current = -1;
-
-        while(!openset.empty())
+        while(!scratch.mHeap.empty())
         {
-            current = openset.front(); // front has the lowest cost
-            openset.pop_front();
+            int current = scratch.closeBest(); // lowest cost
 
             if(current == goal)
-                break;
-
-            closedset.push_back(current); // remember we've been here
+            {
+                // reconstruct path to return
+                for(int point = goal; point != -1; point = scratch.mParent[point])
+                    path.push_back(point);
+                std::reverse(path.begin(), path.end());
+                return true;
+            }
 
             // check all edges for the current point index
-            for(int j = 0; j < static_cast<int> (mGraph[current].edges.size()); j++)
+            const std::vector<ConnectedPoint>& edges = mGraph[current].edges;
+            for(std::vector<ConnectedPoint>::const_iterator edge = edges.begin(); edge != edges.end(); ++edge)
             {
-                if(std::find(closedset.begin(), closedset.end(), mGraph[current].edges[j].index) ==
-                   closedset.end())
+                int dest = edge->index;
+                if(scratch.isClosed(dest))
+                    continue; // traversed this edge destination already
+
+                float tentative_g = scratch.mGScore[current] + edge->cost;
+                if(!scratch.isOpen(dest) || tentative_g < scratch.mGScore[dest])
                 {
-                    // not in closedset - i.e. have not traversed this edge destination
-                    int dest = mGraph[current].edges[j].index;
-                    float tentative_g = gScore[current] + mGraph[current].edges[j].cost;
-                    bool isInOpenSet = std::find(openset.begin(), openset.end(), dest) != openset.end();
-                    if(!isInOpenSet
-                        || tentative_g < gScore[dest])
-                    {
-                        graphParent[dest] = current;
-                        gScore[dest] = tentative_g;
-                        fScore[dest] = tentative_g + costAStar(mPathgrid->mPoints[dest],
-                                                               mPathgrid->mPoints[goal]);
-                        if(!isInOpenSet)
-                        {
-                            // add this edge to openset, lowest cost goes to the front
-                            // TODO: if this causes performance problems a hash table may help
-                            std::list<int>::iterator it = openset.begin();
-                            for(it = openset.begin(); it!= openset.end(); ++it)
-                            {
-                                if(fScore[*it] > fScore[dest])
-                                    break;
-                            }
-                            openset.insert(it, dest);
-                        }
-                    }
-                } // if in closedset, i.e. traversed this edge already, try the next edge
+                    scratch.open(dest, tentative_g, tentative_g + costAStar(mPathgrid->mPoints[dest],
+                                                                            mPathgrid->mPoints[goal]), current);
+                }
             }
         }
 
-        if(current != goal)
-            return path; // for some reason couldn't build a path
+        return false; // for some reason couldn't build a path
+    }
 
-        // reconstruct path to return, using local co-ordinates
-        while(graphParent[current] != -1)
-        {
-            path.push_front(mPathgrid->mPoints[current]);
-            current = graphParent[current];
-        }
+    bool PathgridGraph::findPath(const int start, const int goal, PathgridPath& path,
+                                 AStarScratch& scratch) const
+    {
+        if(mPathCache.find(start, goal, path))
+            return true;
+
+        if(!aStarSearch(start, goal, path, scratch))
+            return false;
 
-        // add first node to path explicitly
-        path.push_front(mPathgrid->mPoints[start]);
-        return path;
+        mPathCache.insert(goal, path);
+        return true;
     }
 }
-
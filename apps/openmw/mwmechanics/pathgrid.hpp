@@ -2,43 +2,106 @@
 #define GAME_MWMECHANICS_PATHGRID_H
 
 #include <components/esm/loadpgrd.hpp>
-#include <list>
+#include <vector>
 
-namespace ESM
+namespace MWMechanics
 {
-    struct Cell;
-}
+    /// Pathgrid point indexes of a path, from the start to the goal point.
+    typedef std::vector<int> PathgridPath;
 
-namespace MWWorld
-{
-    class CellStore;
-}
+    /// @brief Working memory of PathgridGraph::aStarSearch, kept between searches so that they don't allocate.
+    /// @note Not thread safe, every thread that searches for paths needs its own.
+    class AStarScratch
+    {
+        public:
+            AStarScratch();
+
+        private:
+            friend class PathgridGraph;
+
+            /// Forget the state of the previous search, for a graph of the given size.
+            void reset(size_t graphSize);
+
+            bool isOpen(int point) const;
+            bool isClosed(int point) const;
+
+            /// Add a point to the open set, or update the costs of a point that is already in the open set.
+            void open(int point, float gScore, float fScore, int parent);
+            /// Remove the point with the lowest fScore from the open set, and add it to the closed set.
+            int closeBest();
+
+            bool less(int a, int b) const;
+            void siftUp(size_t pos);
+            void siftDown(size_t pos);
+
+            // Indexed by point. Only valid if mGeneration[point] is mCurrentGeneration.
+            std::vector<unsigned int> mGeneration;
+            std::vector<float> mGScore;
+            std::vector<float> mFScore;
+            std::vector<int> mParent;
+            std::vector<int> mHeapPos; ///< Position in mHeap, -1 if closed
+            std::vector<unsigned int> mOrder; ///< When the point was added, to break ties in the order of insertion
+
+            std::vector<int> mHeap; ///< Binary min-heap of the open set, by fScore
+            unsigned int mCurrentGeneration;
+            unsigned int mNextOrder;
+    };
+
+    /// @brief Results of recent path searches in one pathgrid. Followers, guards and combatants that all head for
+    /// the same target keep asking for near-identical paths.
+    class PathgridPathCache
+    {
+        public:
+            PathgridPathCache();
+
+            /// Find a path from start to goal, either from a search for exactly these points, or as the remainder
+            /// of a cached path to the same goal that passes through start.
+            bool find(int start, int goal, PathgridPath& path) const;
+
+            void insert(int goal, const PathgridPath& path);
+
+            void clear();
+
+        private:
+            struct Entry
+            {
+                int mGoal;
+                PathgridPath mPath;
+            };
+
+            std::vector<Entry> mEntries;
+            size_t mNextEntry; ///< The entry to replace next, once the cache is full
+    };
 
-namespace MWMechanics
-{
     class PathgridGraph
     {
         public:
             PathgridGraph();
 
-            bool load(const MWWorld::CellStore *cell);
+            bool load(const ESM::Pathgrid *pathgrid);
 
             // returns true if end point is strongly connected (i.e. reachable
             // from start point) both start and end are pathgrid point indexes
             bool isPointConnected(const int start, const int end) const;
 
             // the input parameters are pathgrid point indexes
-            // the output list is in local (internal cells) or world (external
-            // cells) co-ordinates
+            // the output path contains the indexes of the points to travel,
+            // including start and end
+            //
+            // returns false (with an empty path) if there is no path
+            bool aStarSearch(const int start, const int end, PathgridPath& path,
+                             AStarScratch& scratch) const;
+
+            // same as aStarSearch, but reuses the results of recent searches
             //
-            // NOTE: if start equals end an empty path is returned
-            std::list<ESM::Pathgrid::Point> aStarSearch(const int start,
-                                                        const int end) const;
+            // NOTE: not MT safe
+            bool findPath(const int start, const int end, PathgridPath& path,
+                          AStarScratch& scratch) const;
         private:
 
-            const ESM::Cell *mCell;
             const ESM::Pathgrid *mPathgrid;
-            bool mIsExterior;
+
+            mutable PathgridPathCache mPathCache;
 
             struct ConnectedPoint // edge
             {
@@ -1,6 +1,7 @@
 #include "physicssystem.hpp"
 
 #include <stdexcept>
+#include <iostream>
 
 #include <osg/Group>
 
@@ -23,6 +24,9 @@
 #include <components/esm/loadgmst.hpp>
 #include <components/sceneutil/positionattitudetransform.hpp>
 #include <components/sceneutil/unrefqueue.hpp>
+#include <components/sceneutil/workqueue.hpp>
+
+#include <components/settings/settings.hpp>
 
 #include <components/nifosg/particle.hpp> // FindRecIndexVisitor
 
@@ -58,6 +62,32 @@ namespace MWPhysics
     // Arbitrary number. To prevent infinite loops. They shouldn't happen but it's good to be prepared.
     static const int sMaxIterations = 8;
 
+    /// The state of the game world that the movement of all actors depends on, gathered once per frame.
+    struct WorldFrameData
+    {
+        bool mIsInStorm;
+        osg::Vec3f mStormDirection;
+        float mSwimHeightScale;
+        float mStormWalkMult;
+    };
+
+    /// Everything MovementSolver::move needs to know about an actor's Ptr, gathered on the main thread,
+    /// so that the movement itself does not touch the game world.
+    struct ActorFrameData
+    {
+        Actor* mActor; ///< NULL if the actor was removed or moved elsewhere before its results were used
+        MWWorld::Ptr mPtr;
+        osg::Vec3f mMovement;
+        float mRotX;
+        float mRotZ;
+        bool mIsMobile;
+        bool mIsDead;
+        bool mIsPureWaterCreature;
+        bool mIsFlying;
+        float mWaterLevel;
+        float mSlowFall;
+    };
+
     // FIXME: move to a separate file
     class MovementSolver
     {
@@ -234,14 +264,19 @@ namespace MWPhysics
             }
         }
 
-        static osg::Vec3f move(osg::Vec3f position, const MWWorld::Ptr &ptr, Actor* physicActor, const osg::Vec3f &movement, float time,
-                                  bool isFlying, float waterlevel, float slowFall, btCollisionWorld* collisionWorld,
-                               std::map<MWWorld::Ptr, MWWorld::Ptr>& standingCollisionTracker)
+        /// @param standingOn Set to the object the actor ends up standing on, if any.
+        /// @note Only changes the state of the given actor, so different actors can be moved concurrently.
+        static osg::Vec3f move(osg::Vec3f position, const ActorFrameData& actor, const WorldFrameData& world, float time,
+                               btCollisionWorld* collisionWorld, MWWorld::Ptr& standingOn)
         {
-            const ESM::Position& refpos = ptr.getRefData().getPosition();
+            Actor* physicActor = actor.mActor;
+            const osg::Vec3f& movement = actor.mMovement;
+            const bool isFlying = actor.mIsFlying;
+            const float waterlevel = actor.mWaterLevel;
+
             // Early-out for totally static creatures
             // (Not sure if gravity should still apply?)
-            if (!ptr.getClass().isMobile(ptr))
+            if (!actor.mIsMobile)
                 return position;
 
             // Reset per-frame data
@@ -249,8 +284,8 @@ namespace MWPhysics
             // Anything to collide with?
             if(!physicActor->getCollisionMode())
             {
-                return position +  (osg::Quat(refpos.rot[0], osg::Vec3f(-1, 0, 0)) *
-                                    osg::Quat(refpos.rot[2], osg::Vec3f(0, 0, -1))
+                return position +  (osg::Quat(actor.mRotX, osg::Vec3f(-1, 0, 0)) *
+                                    osg::Quat(actor.mRotZ, osg::Vec3f(0, 0, -1))
                                     ) * movement * time;
             }
 
@@ -263,9 +298,7 @@ namespace MWPhysics
             // While this is strictly speaking wrong, it's needed for MW compatibility.
             position.z() += halfExtents.z();
 
-            static const float fSwimHeightScale = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-                    .find("fSwimHeightScale")->getFloat();
-            float swimlevel = waterlevel + halfExtents.z() - (physicActor->getRenderingHalfExtents().z() * 2 * fSwimHeightScale);
+            float swimlevel = waterlevel + halfExtents.z() - (physicActor->getRenderingHalfExtents().z() * 2 * world.mSwimHeightScale);
 
             ActorTracer tracer;
             osg::Vec3f inertia = physicActor->getInertialForce();
@@ -273,12 +306,12 @@ namespace MWPhysics
 
             if(position.z() < swimlevel || isFlying)
             {
-                velocity = (osg::Quat(refpos.rot[0], osg::Vec3f(-1, 0, 0)) *
-                            osg::Quat(refpos.rot[2], osg::Vec3f(0, 0, -1))) * movement;
+                velocity = (osg::Quat(actor.mRotX, osg::Vec3f(-1, 0, 0)) *
+                            osg::Quat(actor.mRotZ, osg::Vec3f(0, 0, -1))) * movement;
             }
             else
             {
-                velocity = (osg::Quat(refpos.rot[2], osg::Vec3f(0, 0, -1))) * movement;
+                velocity = (osg::Quat(actor.mRotZ, osg::Vec3f(0, 0, -1))) * movement;
 
                 if (velocity.z() > 0.f)
                     inertia = velocity;
@@ -289,19 +322,15 @@ namespace MWPhysics
             }
 
             // dead actors underwater will float to the surface, if the CharacterController tells us to do so
-            if (movement.z() > 0 && ptr.getClass().getCreatureStats(ptr).isDead() && position.z() < swimlevel)
+            if (movement.z() > 0 && actor.mIsDead && position.z() < swimlevel)
                 velocity = osg::Vec3f(0,0,1) * 25;
 
-            ptr.getClass().getMovementSettings(ptr).mPosition[2] = 0;
-
             // Now that we have the effective movement vector, apply wind forces to it
-            if (MWBase::Environment::get().getWorld()->isInStorm())
+            if (world.mIsInStorm)
             {
-                osg::Vec3f stormDirection = MWBase::Environment::get().getWorld()->getStormDirection();
+                const osg::Vec3f& stormDirection = world.mStormDirection;
                 float angleDegrees = osg::RadiansToDegrees(std::acos(stormDirection * velocity / (stormDirection.length() * velocity.length())));
-                static const float fStromWalkMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-                        .find("fStromWalkMult")->getFloat();
-                velocity *= 1.f-(fStromWalkMult * (angleDegrees/180.f));
+                velocity *= 1.f-(world.mStormWalkMult * (angleDegrees/180.f));
             }
 
             osg::Vec3f origVelocity = velocity;
@@ -370,7 +399,7 @@ namespace MWPhysics
                 if(result)
                 {
                     // don't let pure water creatures move out of water after stepMove
-                    if (ptr.getClass().isPureWaterCreature(ptr)
+                    if (actor.mIsPureWaterCreature
                             && newPosition.z() + halfExtents.z() > waterlevel)
                         newPosition = oldPosition;
                 }
@@ -407,12 +436,12 @@ namespace MWPhysics
                 if(tracer.mFraction < 1.0f && getSlope(tracer.mPlaneNormal) <= sMaxSlope
                         && tracer.mHitObject->getBroadphaseHandle()->m_collisionFilterGroup != CollisionType_Actor)
                 {
-                    const btCollisionObject* standingOn = tracer.mHitObject;
-                    PtrHolder* ptrHolder = static_cast<PtrHolder*>(standingOn->getUserPointer());
+                    const btCollisionObject* standingOnObject = tracer.mHitObject;
+                    PtrHolder* ptrHolder = static_cast<PtrHolder*>(standingOnObject->getUserPointer());
                     if (ptrHolder)
-                        standingCollisionTracker[ptr] = ptrHolder->getPtr();
+                        standingOn = ptrHolder->getPtr();
 
-                    if (standingOn->getBroadphaseHandle()->m_collisionFilterGroup == CollisionType_Water)
+                    if (standingOnObject->getBroadphaseHandle()->m_collisionFilterGroup == CollisionType_Water)
                         physicActor->setWalkingOnWater(true);
                     if (!isFlying)
                         newPosition.z() = tracer.mEndPos.z() + 1.0f;
@@ -447,7 +476,7 @@ namespace MWPhysics
             {
                 inertia.z() += time * -627.2f;
                 if (inertia.z() < 0)
-                    inertia.z() *= slowFall;
+                    inertia.z() *= actor.mSlowFall;
                 physicActor->setInertialForce(inertia);
             }
             physicActor->setOnGround(isOnGround);
@@ -457,6 +486,175 @@ namespace MWPhysics
         }
     };
 
+    /// @brief The fixed-size movement steps of one frame, for all actors that had movement queued.
+    /// @par Run directly, or as a work item on the physics thread.
+    /// @note Without solver threads, each actor is moved through all substeps in turn and sees where the actors
+    /// before it ended up, same as always. With solver threads, the actors are moved in lockstep instead: every substep
+    /// moves all actors against the positions the others had at the start of the substep, and only then updates the
+    /// collision world, so the actors of a substep can be moved in parallel. The trade-off is that two actors walking
+    /// into each other in the same substep don't see each other's movement, and can end up overlapping slightly until
+    /// the next substep pushes them apart.
+    class PhysicsStep : public SceneUtil::WorkItem
+    {
+    public:
+        PhysicsStep(btCollisionWorld* collisionWorld, std::map<MWWorld::Ptr, MWWorld::Ptr>& standingCollisions,
+                    SceneUtil::WorkQueue* solverQueue, int numSolverThreads)
+            : mNumSteps(0)
+            , mStepDuration(0.f)
+            , mInterpolationFactor(1.f)
+            , mQueued(false)
+            , mCollisionWorld(collisionWorld)
+            , mStandingCollisions(standingCollisions)
+            , mSolverQueue(solverQueue)
+            , mNumSolverThreads(numSolverThreads)
+        {
+        }
+
+        void addActor(const ActorFrameData& actor)
+        {
+            mActors.push_back(actor);
+            mPositions.push_back(osg::Vec3f());
+            mOldHeights.push_back(0.f);
+            mStandingOn.push_back(MWWorld::Ptr());
+        }
+
+        virtual void doWork();
+
+        /// Move the actors [begin, end) by one substep.
+        void solve(size_t begin, size_t end)
+        {
+            for (size_t i=begin; i<end; ++i)
+            {
+                if (mActors[i].mActor)
+                    mPositions[i] = MovementSolver::move(mPositions[i], mActors[i], mWorld, mStepDuration, mCollisionWorld, mStandingOn[i]);
+            }
+        }
+
+        /// Forget the results for this actor, e.g. because it was removed from the scene.
+        void discardActor(const Actor* actor)
+        {
+            for (std::vector<ActorFrameData>::iterator it = mActors.begin(); it != mActors.end(); ++it)
+            {
+                if (it->mActor == actor)
+                    it->mActor = NULL;
+            }
+        }
+
+        // Indexed by actor
+        std::vector<ActorFrameData> mActors;
+        std::vector<osg::Vec3f> mPositions; ///< Result of the step
+        std::vector<float> mOldHeights;
+        std::vector<MWWorld::Ptr> mStandingOn;
+
+        WorldFrameData mWorld;
+        int mNumSteps;
+        float mStepDuration;
+        float mInterpolationFactor;
+
+        /// Was the step handed to the physics thread?
+        bool mQueued;
+
+    private:
+        btCollisionWorld* mCollisionWorld;
+        std::map<MWWorld::Ptr, MWWorld::Ptr>& mStandingCollisions;
+
+        SceneUtil::WorkQueue* mSolverQueue; ///< NULL to move all actors on the calling thread
+        int mNumSolverThreads;
+    };
+
+    /// Moves a range of the actors of a PhysicsStep by one substep, on a solver thread.
+    class SolverWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        SolverWorkItem(PhysicsStep* step, size_t begin, size_t end)
+            : mStep(step)
+            , mBegin(begin)
+            , mEnd(end)
+        {
+        }
+
+        virtual void doWork()
+        {
+            mStep->solve(mBegin, mEnd);
+        }
+
+    private:
+        PhysicsStep* mStep;
+        size_t mBegin;
+        size_t mEnd;
+    };
+
+    void PhysicsStep::doWork()
+    {
+        if (mNumSteps)
+        {
+            // Collision events should be available on every frame
+            mStandingCollisions.clear();
+        }
+
+        for (size_t i=0; i<mActors.size(); ++i)
+        {
+            if (!mActors[i].mActor)
+                continue;
+            mPositions[i] = mActors[i].mActor->getPosition();
+            mOldHeights[i] = mPositions[i].z();
+        }
+
+        if (!mSolverQueue)
+        {
+            for (size_t i=0; i<mActors.size(); ++i)
+            {
+                Actor* physicActor = mActors[i].mActor;
+                if (!physicActor)
+                    continue;
+                for (int step=0; step<mNumSteps; ++step)
+                {
+                    mPositions[i] = MovementSolver::move(mPositions[i], mActors[i], mWorld, mStepDuration, mCollisionWorld, mStandingOn[i]);
+                    physicActor->setPosition(mPositions[i]);
+                }
+                if (!mStandingOn[i].isEmpty())
+                    mStandingCollisions[mActors[i].mPtr] = mStandingOn[i];
+            }
+            return;
+        }
+
+        // Not worth the synchronization for a handful of actors
+        const size_t minActorsPerThread = 8;
+        const size_t numChunks = std::max<size_t>(1, std::min<size_t>(mNumSolverThreads + 1, mActors.size() / minActorsPerThread));
+        const size_t chunkSize = (mActors.size() + numChunks - 1) / numChunks;
+
+        std::vector<osg::ref_ptr<SolverWorkItem> > items;
+        for (int step=0; step<mNumSteps; ++step)
+        {
+            items.clear();
+            for (size_t begin = chunkSize; begin < mActors.size(); begin += chunkSize)
+            {
+                osg::ref_ptr<SolverWorkItem> item (new SolverWorkItem(this, begin, std::min(begin + chunkSize, mActors.size())));
+                mSolverQueue->addWorkItem(item, SceneUtil::WorkQueue::Priority_High);
+                items.push_back(item);
+            }
+
+            // the first chunk is moved on this thread
+            solve(0, std::min(chunkSize, mActors.size()));
+
+            for (std::vector<osg::ref_ptr<SolverWorkItem> >::const_iterator it = items.begin(); it != items.end(); ++it)
+                (*it)->waitTillDone();
+
+            // the collision world is only changed once no solver is reading from it
+            for (size_t i=0; i<mActors.size(); ++i)
+            {
+                if (!mActors[i].mActor)
+                    continue;
+                mActors[i].mActor->setPosition(mPositions[i]);
+                if (!mStandingOn[i].isEmpty())
+                {
+                    mStandingCollisions[mActors[i].mPtr] = mStandingOn[i];
+                    mStandingOn[i] = MWWorld::Ptr();
+                }
+            }
+        }
+    }
+
 
     // ---------------------------------------------------------------
 
@@ -647,6 +845,8 @@ namespace MWPhysics
         , mResourceSystem(resourceSystem)
         , mDebugDrawEnabled(false)
         , mTimeAccum(0.0f)
+        , mDeterministic(Settings::Manager::getBool("deterministic", "Physics"))
+        , mNumSolverThreads(0)
         , mWaterHeight(0)
         , mWaterEnabled(false)
         , mParentNode(parentNode)
@@ -662,10 +862,31 @@ namespace MWPhysics
         // Don't update AABBs of all objects every frame. Most objects in MW are static, so we don't need this.
         // Should a "static" object ever be moved, we have to update its AABB manually using DynamicsWorld::updateSingleAabb.
         mCollisionWorld->setForceUpdateAllAabbs(false);
+
+        if (Settings::Manager::getBool("async", "Physics"))
+            mPhysicsThread = new SceneUtil::WorkQueue(1);
+
+        int solverThreads = Settings::Manager::getInt("solver threads", "Physics");
+        if (solverThreads > 0)
+        {
+#if defined(BT_THREADSAFE) && BT_THREADSAFE
+            mNumSolverThreads = solverThreads;
+            mSolverThreads = new SceneUtil::WorkQueue(solverThreads);
+#else
+            // concurrent queries would share btDbvtBroadphase's ray test stack
+            std::cerr << "Warning: Ignoring 'solver threads', Bullet was not built with BT_THREADSAFE" << std::endl;
+#endif
+        }
     }
 
     PhysicsSystem::~PhysicsSystem()
     {
+        if (mStep && mStep->mQueued)
+            mStep->waitTillDone();
+        mStep = NULL;
+        mPhysicsThread = NULL;
+        mSolverThreads = NULL;
+
         mResourceSystem->removeResourceManager(mShapeManager.get());
 
         if (mWaterCollisionObject.get())
@@ -706,6 +927,8 @@ namespace MWPhysics
 
     bool PhysicsSystem::toggleDebugRendering()
     {
+        waitForStep();
+
         mDebugDrawEnabled = !mDebugDrawEnabled;
 
         if (mDebugDrawEnabled && !mDebugDrawer.get())
@@ -721,6 +944,8 @@ namespace MWPhysics
 
     void PhysicsSystem::markAsNonSolid(const MWWorld::ConstPtr &ptr)
     {
+        waitForStep();
+
         ObjectMap::iterator found = mObjects.find(ptr);
         if (found == mObjects.end())
             return;
@@ -730,6 +955,8 @@ namespace MWPhysics
 
     bool PhysicsSystem::isOnSolidGround (const MWWorld::Ptr& actor) const
     {
+        waitForStep();
+
         const Actor* physactor = getActor(actor);
         if (!physactor || !physactor->getOnGround())
             return false;
@@ -790,6 +1017,8 @@ namespace MWPhysics
                                                                      const osg::Quat &orient,
                                                                       float queryDistance)
     {
+        waitForStep();
+
         const MWWorld::Store<ESM::GameSetting> &store = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>();
 
         btConeShape shape (osg::DegreesToRadians(store.find("fCombatAngleXY")->getFloat()/2.0f), queryDistance);
@@ -825,6 +1054,8 @@ namespace MWPhysics
 
     float PhysicsSystem::getHitDistance(const osg::Vec3f &point, const MWWorld::ConstPtr &target) const
     {
+        waitForStep();
+
         btCollisionObject* targetCollisionObj = NULL;
         const Actor* actor = getActor(target);
         if (actor)
@@ -874,6 +1105,8 @@ namespace MWPhysics
 
     PhysicsSystem::RayResult PhysicsSystem::castRay(const osg::Vec3f &from, const osg::Vec3f &to, MWWorld::ConstPtr ignore, int mask, int group) const
     {
+        waitForStep();
+
         btVector3 btFrom = toBullet(from);
         btVector3 btTo = toBullet(to);
 
@@ -905,6 +1138,8 @@ namespace MWPhysics
 
     PhysicsSystem::RayResult PhysicsSystem::castSphere(const osg::Vec3f &from, const osg::Vec3f &to, float radius)
     {
+        waitForStep();
+
         btCollisionWorld::ClosestConvexResultCallback callback(toBullet(from), toBullet(to));
         callback.m_collisionFilterGroup = 0xff;
         callback.m_collisionFilterMask = CollisionType_World|CollisionType_HeightMap|CollisionType_Door;
@@ -929,6 +1164,8 @@ namespace MWPhysics
 
     bool PhysicsSystem::getLineOfSight(const MWWorld::ConstPtr &actor1, const MWWorld::ConstPtr &actor2) const
     {
+        waitForStep();
+
         const Actor* physactor1 = getActor(actor1);
         const Actor* physactor2 = getActor(actor2);
 
@@ -955,6 +1192,8 @@ namespace MWPhysics
     // TODO: There might be better places to update PhysicActor::mOnGround.
     bool PhysicsSystem::isOnGround(const MWWorld::Ptr &actor)
     {
+        waitForStep();
+
         Actor* physactor = getActor(actor);
         if(!physactor)
             return false;
@@ -982,6 +1221,8 @@ namespace MWPhysics
 
     osg::Vec3f PhysicsSystem::getHalfExtents(const MWWorld::ConstPtr &actor) const
     {
+        waitForStep();
+
         const Actor* physactor = getActor(actor);
         if (physactor)
             return physactor->getHalfExtents();
@@ -991,6 +1232,8 @@ namespace MWPhysics
 
     osg::Vec3f PhysicsSystem::getRenderingHalfExtents(const MWWorld::ConstPtr &actor) const
     {
+        waitForStep();
+
         const Actor* physactor = getActor(actor);
         if (physactor)
             return physactor->getRenderingHalfExtents();
@@ -1000,6 +1243,8 @@ namespace MWPhysics
 
     osg::Vec3f PhysicsSystem::getCollisionObjectPosition(const MWWorld::ConstPtr &actor) const
     {
+        waitForStep();
+
         const Actor* physactor = getActor(actor);
         if (physactor)
             return physactor->getCollisionObjectPosition();
@@ -1035,6 +1280,8 @@ namespace MWPhysics
 
     std::vector<MWWorld::Ptr> PhysicsSystem::getCollisions(const MWWorld::ConstPtr &ptr, int collisionGroup, int collisionMask) const
     {
+        waitForStep();
+
         btCollisionObject* me = NULL;
 
         ObjectMap::const_iterator found = mObjects.find(ptr);
@@ -1052,6 +1299,8 @@ namespace MWPhysics
 
     osg::Vec3f PhysicsSystem::traceDown(const MWWorld::Ptr &ptr, float maxHeight)
     {
+        waitForStep();
+
         ActorMap::iterator found = mActors.find(ptr);
         if (found ==  mActors.end())
             return ptr.getRefData().getPosition().asVec3();
@@ -1061,6 +1310,8 @@ namespace MWPhysics
 
     void PhysicsSystem::addHeightField (const float* heights, int x, int y, float triSize, float sqrtVerts)
     {
+        waitForStep();
+
         HeightField *heightfield = new HeightField(heights, x, y, triSize, sqrtVerts);
         mHeightFields[std::make_pair(x,y)] = heightfield;
 
@@ -1070,6 +1321,8 @@ namespace MWPhysics
 
     void PhysicsSystem::removeHeightField (int x, int y)
     {
+        waitForStep();
+
         HeightFieldMap::iterator heightfield = mHeightFields.find(std::make_pair(x,y));
         if(heightfield != mHeightFields.end())
         {
@@ -1081,6 +1334,8 @@ namespace MWPhysics
 
     void PhysicsSystem::addObject (const MWWorld::Ptr& ptr, const std::string& mesh, int collisionType)
     {
+        waitForStep();
+
         osg::ref_ptr<Resource::BulletShapeInstance> shapeInstance = mShapeManager->getInstance(mesh);
         if (!shapeInstance || !shapeInstance->getCollisionShape())
             return;
@@ -1097,6 +1352,8 @@ namespace MWPhysics
 
     void PhysicsSystem::remove(const MWWorld::Ptr &ptr)
     {
+        waitForStep();
+
         ObjectMap::iterator found = mObjects.find(ptr);
         if (found != mObjects.end())
         {
@@ -1114,6 +1371,9 @@ namespace MWPhysics
         ActorMap::iterator foundActor = mActors.find(ptr);
         if (foundActor != mActors.end())
         {
+            if (mStep)
+                mStep->discardActor(foundActor->second);
+
             delete foundActor->second;
             mActors.erase(foundActor);
         }
@@ -1137,6 +1397,8 @@ namespace MWPhysics
 
     void PhysicsSystem::updatePtr(const MWWorld::Ptr &old, const MWWorld::Ptr &updated)
     {
+        waitForStep();
+
         ObjectMap::iterator found = mObjects.find(old);
         if (found != mObjects.end())
         {
@@ -1160,6 +1422,8 @@ namespace MWPhysics
 
     Actor *PhysicsSystem::getActor(const MWWorld::Ptr &ptr)
     {
+        waitForStep();
+
         ActorMap::iterator found = mActors.find(ptr);
         if (found != mActors.end())
             return found->second;
@@ -1168,6 +1432,8 @@ namespace MWPhysics
 
     const Actor *PhysicsSystem::getActor(const MWWorld::ConstPtr &ptr) const
     {
+        waitForStep();
+
         ActorMap::const_iterator found = mActors.find(ptr);
         if (found != mActors.end())
             return found->second;
@@ -1176,6 +1442,8 @@ namespace MWPhysics
 
     void PhysicsSystem::updateScale(const MWWorld::Ptr &ptr)
     {
+        waitForStep();
+
         ObjectMap::iterator found = mObjects.find(ptr);
         if (found != mObjects.end())
         {
@@ -1195,6 +1463,8 @@ namespace MWPhysics
 
     void PhysicsSystem::updateRotation(const MWWorld::Ptr &ptr)
     {
+        waitForStep();
+
         ObjectMap::iterator found = mObjects.find(ptr);
         if (found != mObjects.end())
         {
@@ -1213,6 +1483,8 @@ namespace MWPhysics
 
     void PhysicsSystem::updatePosition(const MWWorld::Ptr &ptr)
     {
+        waitForStep();
+
         ObjectMap::iterator found = mObjects.find(ptr);
         if (found != mObjects.end())
         {
@@ -1223,6 +1495,10 @@ namespace MWPhysics
         ActorMap::iterator foundActor = mActors.find(ptr);
         if (foundActor != mActors.end())
         {
+            // the actor was placed explicitly, e.g. teleported, so the pending movement is obsolete
+            if (mStep)
+                mStep->discardActor(foundActor->second);
+
             foundActor->second->updatePosition();
             mCollisionWorld->updateSingleAabb(foundActor->second->getCollisionObject());
             return;
@@ -1230,6 +1506,8 @@ namespace MWPhysics
     }
 
     void PhysicsSystem::addActor (const MWWorld::Ptr& ptr, const std::string& mesh) {
+        waitForStep();
+
         osg::ref_ptr<const Resource::BulletShape> shape = mShapeManager->getShape(mesh);
         if (!shape)
             return;
@@ -1240,6 +1518,8 @@ namespace MWPhysics
 
     bool PhysicsSystem::toggleCollisionMode()
     {
+        waitForStep();
+
         ActorMap::iterator found = mActors.find(MWMechanics::getPlayer());
         if (found != mActors.end())
         {
@@ -1269,6 +1549,9 @@ namespace MWPhysics
 
     void PhysicsSystem::clearQueuedMovement()
     {
+        waitForStep();
+        mStep = NULL;
+
         mMovementQueue.clear();
         mStandingCollisions.clear();
     }
@@ -1277,22 +1560,46 @@ namespace MWPhysics
     {
         mMovementResults.clear();
 
-        mTimeAccum += dt;
+        // the results of the previous frame's step, in asynchronous mode
+        waitForStep();
+        if (mStep)
+        {
+            collectStepResults();
+            mStep = NULL;
+        }
+
         const float physicsDt = 1.f/60.0f;
 
-        const int maxAllowedSteps = 20;
-        int numSteps = mTimeAccum / (physicsDt);
-        numSteps = std::min(numSteps, maxAllowedSteps);
+        int numSteps = 1;
+        if (!mDeterministic)
+        {
+            mTimeAccum += dt;
 
-        mTimeAccum -= numSteps * physicsDt;
+            const int maxAllowedSteps = 20;
+            numSteps = mTimeAccum / (physicsDt);
+            if (numSteps > maxAllowedSteps)
+            {
+                // Drop the time we can't catch up on, rather than carrying it over to the next frames,
+                // which would only make them slower as well
+                numSteps = maxAllowedSteps;
+                mTimeAccum = numSteps * physicsDt;
+            }
 
-        if (numSteps)
-        {
-            // Collision events should be available on every frame
-            mStandingCollisions.clear();
+            mTimeAccum -= numSteps * physicsDt;
         }
 
+        osg::ref_ptr<PhysicsStep> step (new PhysicsStep(mCollisionWorld, mStandingCollisions, mSolverThreads.get(), mNumSolverThreads));
+        step->mNumSteps = numSteps;
+        step->mStepDuration = physicsDt;
+        step->mInterpolationFactor = mDeterministic ? 1.f : mTimeAccum / physicsDt;
+
         const MWBase::World *world = MWBase::Environment::get().getWorld();
+        const MWWorld::Store<ESM::GameSetting>& gmst = world->getStore().get<ESM::GameSetting>();
+        step->mWorld.mIsInStorm = world->isInStorm();
+        step->mWorld.mStormDirection = world->getStormDirection();
+        step->mWorld.mSwimHeightScale = gmst.find("fSwimHeightScale")->getFloat();
+        step->mWorld.mStormWalkMult = gmst.find("fStromWalkMult")->getFloat();
+
         PtrVelocityList::iterator iter = mMovementQueue.begin();
         for(;iter != mMovementQueue.end();++iter)
         {
@@ -1317,37 +1624,92 @@ namespace MWPhysics
             Actor* physicActor = foundActor->second;
             physicActor->setCanWaterWalk(waterCollision);
 
+            const ESM::Position& refpos = iter->first.getRefData().getPosition();
+
+            ActorFrameData actor;
+            actor.mActor = physicActor;
+            actor.mPtr = iter->first;
+            actor.mMovement = iter->second;
+            actor.mRotX = refpos.rot[0];
+            actor.mRotZ = refpos.rot[2];
+            actor.mIsMobile = iter->first.getClass().isMobile(iter->first);
+            actor.mIsDead = iter->first.getClass().getCreatureStats(iter->first).isDead();
+            actor.mIsPureWaterCreature = iter->first.getClass().isPureWaterCreature(iter->first);
+            actor.mIsFlying = world->isFlying(iter->first);
+            actor.mWaterLevel = waterlevel;
             // Slow fall reduces fall speed by a factor of (effect magnitude / 200)
-            float slowFall = 1.f - std::max(0.f, std::min(1.f, effects.get(ESM::MagicEffect::SlowFall).getMagnitude() * 0.005f));
+            actor.mSlowFall = 1.f - std::max(0.f, std::min(1.f, effects.get(ESM::MagicEffect::SlowFall).getMagnitude() * 0.005f));
+            step->addActor(actor);
 
-            osg::Vec3f position = physicActor->getPosition();
-            float oldHeight = position.z();
-            for (int i=0; i<numSteps; ++i)
-            {
-                position = MovementSolver::move(position, physicActor->getPtr(), physicActor, iter->second, physicsDt,
-                                                world->isFlying(iter->first),
-                                                waterlevel, slowFall, mCollisionWorld, mStandingCollisions);
-                physicActor->setPosition(position);
-            }
+            // consumed by the step
+            if (numSteps && actor.mIsMobile && physicActor->getCollisionMode())
+                iter->first.getClass().getMovementSettings(iter->first).mPosition[2] = 0;
+        }
 
-            float interpolationFactor = mTimeAccum / physicsDt;
-            osg::Vec3f interpolated = position * interpolationFactor + physicActor->getPreviousPosition() * (1.f - interpolationFactor);
+        mMovementQueue.clear();
 
-            float heightDiff = position.z() - oldHeight;
+        mStep = step;
+        if (!mPhysicsThread)
+        {
+            step->doWork();
+            step->signalDone();
+            collectStepResults();
+            mStep = NULL;
+        }
 
-            if (heightDiff < 0)
-                iter->first.getClass().getCreatureStats(iter->first).addToFallHeight(-heightDiff);
+        return mMovementResults;
+    }
 
-            mMovementResults.push_back(std::make_pair(iter->first, interpolated));
+    void PhysicsSystem::startPendingStep()
+    {
+        if (mStep && !mStep->mQueued && !mStep->isDone())
+        {
+            mStep->mQueued = true;
+            mPhysicsThread->addWorkItem(mStep, SceneUtil::WorkQueue::Priority_High);
         }
+    }
 
-        mMovementQueue.clear();
+    void PhysicsSystem::waitForStep() const
+    {
+        if (!mStep || mStep->isDone())
+            return;
 
-        return mMovementResults;
+        if (mStep->mQueued)
+            mStep->waitTillDone();
+        else
+        {
+            // the collision world is needed before the step was handed over, so just run it here
+            mStep->doWork();
+            mStep->signalDone();
+        }
+    }
+
+    void PhysicsSystem::collectStepResults()
+    {
+        for (size_t i=0; i<mStep->mActors.size(); ++i)
+        {
+            Actor* physicActor = mStep->mActors[i].mActor;
+            if (!physicActor) // actor was removed from the scene or placed elsewhere in the meantime
+                continue;
+
+            const MWWorld::Ptr& ptr = physicActor->getPtr();
+            const osg::Vec3f& position = mStep->mPositions[i];
+            osg::Vec3f interpolated = position * mStep->mInterpolationFactor
+                    + physicActor->getPreviousPosition() * (1.f - mStep->mInterpolationFactor);
+
+            float heightDiff = position.z() - mStep->mOldHeights[i];
+
+            if (heightDiff < 0)
+                ptr.getClass().getCreatureStats(ptr).addToFallHeight(-heightDiff);
+
+            mMovementResults.push_back(std::make_pair(ptr, interpolated));
+        }
     }
 
     void PhysicsSystem::stepSimulation(float dt)
     {
+        waitForStep();
+
         for (std::set<Object*>::iterator it = mAnimatedObjects.begin(); it != mAnimatedObjects.end(); ++it)
             (*it)->animateCollisionShapes(mCollisionWorld);
 
@@ -1357,12 +1719,16 @@ namespace MWPhysics
 
     void PhysicsSystem::debugDraw()
     {
+        waitForStep();
+
         if (mDebugDrawer.get())
             mDebugDrawer->step();
     }
 
     bool PhysicsSystem::isActorStandingOn(const MWWorld::Ptr &actor, const MWWorld::ConstPtr &object) const
     {
+        waitForStep();
+
         for (CollisionMap::const_iterator it = mStandingCollisions.begin(); it != mStandingCollisions.end(); ++it)
         {
             if (it->first == actor && it->second == object)
@@ -1373,6 +1739,8 @@ namespace MWPhysics
 
     void PhysicsSystem::getActorsStandingOn(const MWWorld::ConstPtr &object, std::vector<MWWorld::Ptr> &out) const
     {
+        waitForStep();
+
         for (CollisionMap::const_iterator it = mStandingCollisions.begin(); it != mStandingCollisions.end(); ++it)
         {
             if (it->second == object)
@@ -1382,18 +1750,24 @@ namespace MWPhysics
 
     bool PhysicsSystem::isActorCollidingWith(const MWWorld::Ptr &actor, const MWWorld::ConstPtr &object) const
     {
+        waitForStep();
+
         std::vector<MWWorld::Ptr> collisions = getCollisions(object, CollisionType_World, CollisionType_Actor);
         return (std::find(collisions.begin(), collisions.end(), actor) != collisions.end());
     }
 
     void PhysicsSystem::getActorsCollidingWith(const MWWorld::ConstPtr &object, std::vector<MWWorld::Ptr> &out) const
     {
+        waitForStep();
+
         std::vector<MWWorld::Ptr> collisions = getCollisions(object, CollisionType_World, CollisionType_Actor);
         out.insert(out.end(), collisions.begin(), collisions.end());
     }
 
     void PhysicsSystem::disableWater()
     {
+        waitForStep();
+
         if (mWaterEnabled)
         {
             mWaterEnabled = false;
@@ -1403,6 +1777,8 @@ namespace MWPhysics
 
     void PhysicsSystem::enableWater(float height)
     {
+        waitForStep();
+
         if (!mWaterEnabled || mWaterHeight != height)
         {
             mWaterEnabled = true;
@@ -1413,6 +1789,8 @@ namespace MWPhysics
 
     void PhysicsSystem::setWaterHeight(float height)
     {
+        waitForStep();
+
         if (mWaterHeight != height)
         {
             mWaterHeight = height;
@@ -31,6 +31,7 @@ namespace Resource
 namespace SceneUtil
 {
     class UnrefQueue;
+    class WorkQueue;
 }
 
 class btCollisionWorld;
@@ -47,6 +48,7 @@ namespace MWPhysics
     class HeightField;
     class Object;
     class Actor;
+    class PhysicsStep;
 
     class PhysicsSystem
     {
@@ -136,8 +138,14 @@ namespace MWPhysics
             void queueObjectMovement(const MWWorld::Ptr &ptr, const osg::Vec3f &velocity);
 
             /// Apply all queued movements, then clear the list.
+            /// @note In asynchronous mode, the movement is only prepared here and run on the physics thread
+            /// once startPendingStep() is called. The results returned are those of the previous frame's movement.
             const PtrVelocityList& applyQueuedMovement(float dt);
 
+            /// Hand the movement prepared by applyQueuedMovement over to the physics thread, so that it runs
+            /// while the frame is rendered. Does nothing unless asynchronous physics are enabled.
+            void startPendingStep();
+
             /// Clear the queued movements list without applying.
             void clearQueuedMovement();
 
@@ -168,6 +176,13 @@ namespace MWPhysics
 
             void updateWater();
 
+            /// Finish the pending physics step, if any, so that the collision world can be used.
+            /// @note Must be called before accessing the collision world, actors or standing collisions.
+            void waitForStep() const;
+
+            /// Append the movement results of mStep to mMovementResults.
+            void collectStepResults();
+
             osg::ref_ptr<SceneUtil::UnrefQueue> mUnrefQueue;
 
             btBroadphaseInterface* mBroadphase;
@@ -204,6 +219,15 @@ namespace MWPhysics
 
             float mTimeAccum;
 
+            /// Always run exactly one fixed-size step per frame, regardless of the frame duration.
+            bool mDeterministic;
+
+            osg::ref_ptr<SceneUtil::WorkQueue> mPhysicsThread; ///< NULL unless asynchronous physics are enabled
+            osg::ref_ptr<PhysicsStep> mStep;
+
+            int mNumSolverThreads;
+            osg::ref_ptr<SceneUtil::WorkQueue> mSolverThreads; ///< Move actors in parallel. NULL if disabled.
+
             float mWaterHeight;
             float mWaterEnabled;
 
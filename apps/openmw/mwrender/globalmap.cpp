@@ -1,6 +1,11 @@
 #include "globalmap.hpp"
 
 #include <climits>
+#include <cstring>
+#include <ctime>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
 
 #include <osg/Image>
 #include <osg/Texture2D>
@@ -16,6 +21,7 @@
 #include <components/files/memorystream.hpp>
 
 #include <components/esm/globalmap.hpp>
+#include <components/esm/esmreader.hpp>
 
 #include "../mwbase/environment.hpp"
 #include "../mwbase/world.hpp"
@@ -59,6 +65,40 @@ namespace
     }
 
 
+    const char sCacheMagic[8] = { 'O', 'M', 'W', 'G', 'M', 'A', 'P', '1' };
+
+    void getMapColour(signed char height, unsigned char* rgb)
+    {
+        float y = (height << 4) / 2048.f;
+        if (y < 0)
+        {
+            rgb[0] = static_cast<unsigned char>(14 * y + 38);
+            rgb[1] = static_cast<unsigned char>(20 * y + 56);
+            rgb[2] = static_cast<unsigned char>(18 * y + 51);
+        }
+        else if (y < 0.3f)
+        {
+            if (y < 0.1f)
+                y *= 8.f;
+            else
+            {
+                y -= 0.1f;
+                y += 0.8f;
+            }
+            rgb[0] = static_cast<unsigned char>(66 - 32 * y);
+            rgb[1] = static_cast<unsigned char>(48 - 23 * y);
+            rgb[2] = static_cast<unsigned char>(33 - 16 * y);
+        }
+        else
+        {
+            y -= 0.3f;
+            y *= 1.428f;
+            rgb[0] = static_cast<unsigned char>(34 - 29 * y);
+            rgb[1] = static_cast<unsigned char>(25 - 20 * y);
+            rgb[2] = static_cast<unsigned char>(17 - 12 * y);
+        }
+    }
+
     class CameraUpdateGlobalCallback : public osg::NodeCallback
     {
     public:
@@ -110,7 +150,7 @@ namespace MWRender
     {
     }
 
-    void GlobalMap::render (Loading::Listener* loadingListener)
+    void GlobalMap::render (Loading::Listener* loadingListener, const std::string& cacheDir)
     {
         const MWWorld::ESMStore &esmStore =
             MWBase::Environment::get().getWorld()->getStore();
@@ -139,12 +179,56 @@ namespace MWRender
 
         osg::ref_ptr<osg::Image> image = new osg::Image;
         image->allocateImage(mWidth, mHeight, 1, GL_RGB, GL_UNSIGNED_BYTE);
-        unsigned char* data = image->data();
 
+        std::string cacheFile;
+        uint64_t contentHash = 0;
+        if (!cacheDir.empty() && Settings::Manager::getBool("global map cache", "Map"))
+        {
+            cacheFile = (boost::filesystem::path(cacheDir) / "globalmap.bin").string();
+            contentHash = getContentHash();
+        }
+
+        if (cacheFile.empty() || !readCache(cacheFile, contentHash, *image))
+        {
+            rasterize(*image, loadingListener);
+
+            if (!cacheFile.empty())
+                writeCache(cacheFile, contentHash, *image);
+        }
+
+        mBaseTexture = new osg::Texture2D;
+        mBaseTexture->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
+        mBaseTexture->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
+        mBaseTexture->setFilter(osg::Texture::MIN_FILTER, osg::Texture::LINEAR);
+        mBaseTexture->setFilter(osg::Texture::MAG_FILTER, osg::Texture::LINEAR);
+        mBaseTexture->setImage(image);
+        mBaseTexture->setResizeNonPowerOfTwoHint(false);
+
+        clear();
+
+        loadingListener->loadingOff();
+    }
+
+    void GlobalMap::rasterize(osg::Image& image, Loading::Listener* loadingListener)
+    {
+        const MWWorld::ESMStore &esmStore =
+            MWBase::Environment::get().getWorld()->getStore();
+
+        std::vector<unsigned char> colours (256*3);
+        for (int height=SCHAR_MIN; height<=SCHAR_MAX; ++height)
+            getMapColour(static_cast<signed char>(height), &colours[(height - SCHAR_MIN) * 3]);
+
+        std::vector<int> vertices (mCellSize);
+        for (int i=0; i<mCellSize; ++i)
+            vertices[i] = static_cast<int>(float(i)/float(mCellSize) * 9);
+
+        std::vector<signed char> heights (81);
         for (int x = mMinX; x <= mMaxX; ++x)
         {
             for (int y = mMinY; y <= mMaxY; ++y)
             {
+                std::fill(heights.begin(), heights.end(), SCHAR_MIN);
+
                 ESM::Land* land = esmStore.get<ESM::Land>().search (x,y);
 
                 if (land)
@@ -152,78 +236,95 @@ namespace MWRender
                     int mask = ESM::Land::DATA_WNAM;
                     if (!land->isDataLoaded(mask))
                         land->loadData(mask);
-                }
 
-                const ESM::Land::LandData *landData =
-                    land ? land->getLandData (ESM::Land::DATA_WNAM) : 0;
+                    const ESM::Land::LandData *landData = land->getLandData (ESM::Land::DATA_WNAM);
+                    if (landData)
+                        std::copy(landData->mWnam, landData->mWnam + 81, heights.begin());
+
+                    land->unloadData();
+                }
 
                 for (int cellY=0; cellY<mCellSize; ++cellY)
                 {
+                    unsigned char* row = image.data() + (((y-mMinY) * mCellSize + cellY) * mWidth + (x-mMinX) * mCellSize) * 3;
+                    const signed char* wnamRow = &heights[vertices[cellY] * 9];
                     for (int cellX=0; cellX<mCellSize; ++cellX)
                     {
-                        int vertexX = static_cast<int>(float(cellX)/float(mCellSize) * 9);
-                        int vertexY = static_cast<int>(float(cellY) / float(mCellSize) * 9);
-
-                        int texelX = (x-mMinX) * mCellSize + cellX;
-                        int texelY = (y-mMinY) * mCellSize + cellY;
-
-                        unsigned char r,g,b;
-
-                        float y = 0;
-                        if (landData)
-                            y = (landData->mWnam[vertexY * 9 + vertexX] << 4) / 2048.f;
-                        else
-                            y = (SCHAR_MIN << 4) / 2048.f;
-                        if (y < 0)
-                        {
-                            r = static_cast<unsigned char>(14 * y + 38);
-                            g = static_cast<unsigned char>(20 * y + 56);
-                            b = static_cast<unsigned char>(18 * y + 51);
-                        }
-                        else if (y < 0.3f)
-                        {
-                            if (y < 0.1f)
-                                y *= 8.f;
-                            else
-                            {
-                                y -= 0.1f;
-                                y += 0.8f;
-                            }
-                            r = static_cast<unsigned char>(66 - 32 * y);
-                            g = static_cast<unsigned char>(48 - 23 * y);
-                            b = static_cast<unsigned char>(33 - 16 * y);
-                        }
-                        else
-                        {
-                            y -= 0.3f;
-                            y *= 1.428f;
-                            r = static_cast<unsigned char>(34 - 29 * y);
-                            g = static_cast<unsigned char>(25 - 20 * y);
-                            b = static_cast<unsigned char>(17 - 12 * y);
-                        }
-
-                        data[texelY * mWidth * 3 + texelX * 3] = r;
-                        data[texelY * mWidth * 3 + texelX * 3+1] = g;
-                        data[texelY * mWidth * 3 + texelX * 3+2] = b;
+                        const unsigned char* colour = &colours[(wnamRow[vertices[cellX]] - SCHAR_MIN) * 3];
+                        row[cellX * 3] = colour[0];
+                        row[cellX * 3 + 1] = colour[1];
+                        row[cellX * 3 + 2] = colour[2];
                     }
                 }
+
                 loadingListener->increaseProgress();
-                if (land)
-                    land->unloadData();
             }
         }
+    }
 
-        mBaseTexture = new osg::Texture2D;
-        mBaseTexture->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
-        mBaseTexture->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
-        mBaseTexture->setFilter(osg::Texture::MIN_FILTER, osg::Texture::LINEAR);
-        mBaseTexture->setFilter(osg::Texture::MAG_FILTER, osg::Texture::LINEAR);
-        mBaseTexture->setImage(image);
-        mBaseTexture->setResizeNonPowerOfTwoHint(false);
+    uint64_t GlobalMap::getContentHash()
+    {
+        // FNV-1a over the content files' paths, sizes and modification times, so that editing a plugin invalidates the cache
+        uint64_t hash = 14695981039346656037ULL;
+        std::vector<ESM::ESMReader>& readers = MWBase::Environment::get().getWorld()->getEsmReader();
+        for (std::vector<ESM::ESMReader>::const_iterator it = readers.begin(); it != readers.end(); ++it)
+        {
+            std::ostringstream stream;
+            stream << it->getName() << '\0' << it->getFileSize() << '\0';
+            boost::system::error_code ec;
+            std::time_t time = boost::filesystem::last_write_time(it->getName(), ec);
+            if (!ec)
+                stream << time;
+            stream << '\0';
+
+            std::string key = stream.str();
+            for (std::string::const_iterator c = key.begin(); c != key.end(); ++c)
+            {
+                hash ^= static_cast<unsigned char>(*c);
+                hash *= 1099511628211ULL;
+            }
+        }
+        return hash;
+    }
 
-        clear();
+    bool GlobalMap::readCache(const std::string& file, uint64_t contentHash, osg::Image& image)
+    {
+        boost::filesystem::ifstream stream (file, std::ios::binary);
+        if (!stream.is_open())
+            return false;
+
+        char magic[sizeof(sCacheMagic)];
+        uint64_t hash = 0;
+        int header[5];
+        stream.read(magic, sizeof(magic));
+        stream.read(reinterpret_cast<char*>(&hash), sizeof(hash));
+        stream.read(reinterpret_cast<char*>(header), sizeof(header));
+        if (!stream.good() || std::memcmp(magic, sCacheMagic, sizeof(magic)) != 0 || hash != contentHash
+                || header[0] != mCellSize || header[1] != mMinX || header[2] != mMaxX || header[3] != mMinY || header[4] != mMaxY)
+            return false;
+
+        stream.read(reinterpret_cast<char*>(image.data()), image.getTotalSizeInBytes());
+        return stream.gcount() == static_cast<std::streamsize>(image.getTotalSizeInBytes());
+    }
 
-        loadingListener->loadingOff();
+    void GlobalMap::writeCache(const std::string& file, uint64_t contentHash, const osg::Image& image)
+    {
+        boost::filesystem::path path (file);
+        boost::system::error_code ec;
+        boost::filesystem::create_directories(path.parent_path(), ec);
+
+        boost::filesystem::ofstream stream (path, std::ios::binary | std::ios::trunc);
+        if (stream.is_open())
+        {
+            int header[5] = { mCellSize, mMinX, mMaxX, mMinY, mMaxY };
+            stream.write(sCacheMagic, sizeof(sCacheMagic));
+            stream.write(reinterpret_cast<const char*>(&contentHash), sizeof(contentHash));
+            stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+            stream.write(reinterpret_cast<const char*>(image.data()), image.getTotalSizeInBytes());
+        }
+
+        if (!stream.is_open() || !stream.good())
+            std::cerr << "Warning: Can't write world map cache " << file << std::endl;
     }
 
     void GlobalMap::worldPosToImageSpace(float x, float z, float& imageX, float& imageY)
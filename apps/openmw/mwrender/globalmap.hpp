@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include <stdint.h>
 
 #include <osg/ref_ptr>
 
@@ -33,7 +34,9 @@ namespace MWRender
         GlobalMap(osg::Group* root);
         ~GlobalMap();
 
-        void render(Loading::Listener* loadingListener);
+        /// Create the base texture of the world map from the water map heights of the exterior cells.
+        /// @param cacheDir Directory to keep the base image in across runs, or empty for no caching.
+        void render(Loading::Listener* loadingListener, const std::string& cacheDir);
 
         int getWidth() const { return mWidth; }
         int getHeight() const { return mHeight; }
@@ -68,6 +71,14 @@ namespace MWRender
         osg::ref_ptr<osg::Texture2D> getOverlayTexture();
 
     private:
+        void rasterize(osg::Image& image, Loading::Listener* loadingListener);
+
+        /// Identifies the content files the base image was created from.
+        uint64_t getContentHash();
+
+        bool readCache(const std::string& file, uint64_t contentHash, osg::Image& image);
+        void writeCache(const std::string& file, uint64_t contentHash, const osg::Image& image);
+
         /**
          * Request rendering a 2d quad onto mOverlayTexture.
          * x, y, width and height are the destination coordinates (top-left coordinate origin)
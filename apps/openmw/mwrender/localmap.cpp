@@ -1,8 +1,11 @@
 #include "localmap.hpp"
 
+#include <cstring>
 #include <iostream>
 #include <stdint.h>
 
+#include <boost/functional/hash.hpp>
+
 #include <osg/Fog>
 #include <osg/LightModel>
 #include <osg/Texture2D>
@@ -22,6 +25,7 @@
 #include "../mwbase/world.hpp"
 
 #include "../mwworld/cellstore.hpp"
+#include "../mwworld/class.hpp"
 
 #include "vismask.hpp"
 
@@ -63,6 +67,38 @@ namespace
         return val*val;
     }
 
+    /// Hashes the placement of the objects that are drawn on the local map, to tell when a cell's map needs to be redrawn.
+    struct MapSignatureVisitor
+    {
+        MapSignatureVisitor()
+            : mHash(0)
+        {
+        }
+
+        bool operator()(const MWWorld::ConstPtr& ptr)
+        {
+            // actors are not drawn on the map, and would invalidate it whenever they move
+            if (ptr.getClass().isActor())
+                return true;
+
+            const MWWorld::RefData& data = ptr.getRefData();
+            if (!data.isEnabled() || data.getCount() == 0)
+                return true;
+
+            boost::hash_combine(mHash, ptr.getCellRef().getRefId());
+            boost::hash_combine(mHash, ptr.getCellRef().getScale());
+            const ESM::Position& pos = data.getPosition();
+            for (int i=0; i<3; ++i)
+            {
+                boost::hash_combine(mHash, pos.pos[i]);
+                boost::hash_combine(mHash, pos.rot[i]);
+            }
+            return true;
+        }
+
+        size_t mHash;
+    };
+
 }
 
 namespace MWRender
@@ -70,6 +106,9 @@ namespace MWRender
 
 LocalMap::LocalMap(osgViewer::Viewer* viewer)
     : mViewer(viewer)
+    , mRendersPerFrame(Settings::Manager::getInt("local map renders per frame", "Map"))
+    , mCacheSize(static_cast<unsigned int>(std::max(0, Settings::Manager::getInt("local map cache size", "Map"))))
+    , mCacheTime(0)
     , mMapResolution(Settings::Manager::getInt("local map resolution", "Map"))
     , mMapWorldSize(8192.f)
     , mCellDistance(Settings::Manager::getInt("local map cell distance", "Map"))
@@ -102,6 +141,8 @@ const osg::Vec2f LocalMap::rotatePoint(const osg::Vec2f& point, const osg::Vec2f
 void LocalMap::clear()
 {
     mSegments.clear();
+    mCachedMaps.clear();
+    mPendingRenders.clear();
 }
 
 void LocalMap::saveFogOfWar(MWWorld::CellStore* cell)
@@ -217,22 +258,78 @@ osg::ref_ptr<osg::Camera> LocalMap::createOrthographicCamera(float x, float y, f
 
 void LocalMap::setupRenderToTexture(osg::ref_ptr<osg::Camera> camera, int x, int y)
 {
-    osg::ref_ptr<osg::Texture2D> texture (new osg::Texture2D);
-    texture->setTextureSize(mMapResolution, mMapResolution);
-    texture->setInternalFormat(GL_RGB);
-    texture->setFilter(osg::Texture::MIN_FILTER, osg::Texture::LINEAR);
-    texture->setFilter(osg::Texture::MAG_FILTER, osg::Texture::LINEAR);
-    texture->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
-    texture->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
+    MapSegment& segment = mSegments[std::make_pair(x, y)];
 
-    camera->attach(osg::Camera::COLOR_BUFFER, texture);
+    // Render into the segment's existing texture, so the GUI keeps showing the old map until the new one is done
+    osg::ref_ptr<osg::Texture2D> texture = segment.mMapTexture;
+    if (!texture)
+    {
+        texture = new osg::Texture2D;
+        texture->setTextureSize(mMapResolution, mMapResolution);
+        texture->setInternalFormat(GL_RGB);
+        texture->setFilter(osg::Texture::MIN_FILTER, osg::Texture::LINEAR);
+        texture->setFilter(osg::Texture::MAG_FILTER, osg::Texture::LINEAR);
+        texture->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
+        texture->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
+
+        // The GUI gets the texture right away, but the camera may only be started a few frames later, see cleanupCameras().
+        // Show an empty map until then instead of whatever the uninitialized texture memory holds.
+        osg::ref_ptr<osg::Image> image (new osg::Image);
+        image->allocateImage(mMapResolution, mMapResolution, 1, GL_RGB, GL_UNSIGNED_BYTE);
+        memset(image->data(), 0, image->getTotalSizeInBytes());
+        texture->setImage(image);
+        texture->setUnRefImageDataAfterApply(true);
+
+        segment.mMapTexture = texture;
+    }
+    else
+    {
+        // a newer render of the same texture replaces one that is still queued
+        removePendingRender(texture);
+    }
 
+    camera->attach(osg::Camera::COLOR_BUFFER, texture);
     camera->addChild(mSceneRoot);
-    mRoot->addChild(camera);
-    mActiveCameras.push_back(camera);
 
-    MapSegment& segment = mSegments[std::make_pair(x, y)];
-    segment.mMapTexture = texture;
+    PendingRender render;
+    render.mCamera = camera;
+    render.mTexture = texture;
+    mPendingRenders.push_back(render);
+}
+
+bool LocalMap::removePendingRender(osg::Texture2D *texture)
+{
+    for (std::deque<PendingRender>::iterator it = mPendingRenders.begin(); it != mPendingRenders.end(); ++it)
+    {
+        if (it->mTexture == texture)
+        {
+            mPendingRenders.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+void LocalMap::cacheMap(const std::pair<int, int> &cell, const MapSegment &segment)
+{
+    if (mCacheSize == 0)
+        return;
+
+    CachedMap& cached = mCachedMaps[cell];
+    cached.mTexture = segment.mMapTexture;
+    cached.mSignature = segment.mMapSignature;
+    cached.mLastUsed = ++mCacheTime;
+
+    if (mCachedMaps.size() > mCacheSize)
+    {
+        CachedMapMap::iterator oldest = mCachedMaps.begin();
+        for (CachedMapMap::iterator it = mCachedMaps.begin(); it != mCachedMaps.end(); ++it)
+        {
+            if (it->second.mLastUsed < oldest->second.mLastUsed)
+                oldest = it;
+        }
+        mCachedMaps.erase(oldest);
+    }
 }
 
 void LocalMap::requestMap(std::set<const MWWorld::CellStore*> cells)
@@ -252,9 +349,28 @@ void LocalMap::removeCell(MWWorld::CellStore *cell)
     saveFogOfWar(cell);
 
     if (cell->isExterior())
-        mSegments.erase(std::make_pair(cell->getCell()->getGridX(), cell->getCell()->getGridY()));
+    {
+        std::pair<int, int> key = std::make_pair(cell->getCell()->getGridX(), cell->getCell()->getGridY());
+        SegmentMap::iterator found = mSegments.find(key);
+        if (found == mSegments.end())
+            return;
+
+        // a map that has not been rendered yet is not worth keeping
+        const MapSegment& segment = found->second;
+        if (segment.mMapTexture && !removePendingRender(segment.mMapTexture) && segment.mHasMapSignature)
+            cacheMap(key, segment);
+
+        mSegments.erase(found);
+    }
     else
+    {
+        for (SegmentMap::iterator it = mSegments.begin(); it != mSegments.end(); ++it)
+        {
+            if (it->second.mMapTexture)
+                removePendingRender(it->second.mMapTexture);
+        }
         mSegments.clear();
+    }
 }
 
 osg::ref_ptr<osg::Texture2D> LocalMap::getMapTexture(int x, int y)
@@ -289,9 +405,6 @@ void LocalMap::markForRemoval(osg::Camera *cam)
 
 void LocalMap::cleanupCameras()
 {
-    if (mCamerasPendingRemoval.empty())
-        return;
-
     for (CameraVector::iterator it = mCamerasPendingRemoval.begin(); it != mCamerasPendingRemoval.end(); ++it)
     {
         (*it)->removeChildren(0, (*it)->getNumChildren());
@@ -300,6 +413,16 @@ void LocalMap::cleanupCameras()
     }
 
     mCamerasPendingRemoval.clear();
+
+    // spread the render passes over several frames, since maps are requested while the new cells are being loaded
+    for (int i=0; !mPendingRenders.empty() && (mRendersPerFrame <= 0 || i < mRendersPerFrame); ++i)
+    {
+        osg::ref_ptr<osg::Camera> camera = mPendingRenders.front().mCamera;
+        mPendingRenders.pop_front();
+
+        mRoot->addChild(camera);
+        mActiveCameras.push_back(camera);
+    }
 }
 
 void LocalMap::requestExteriorMap(const MWWorld::CellStore* cell)
@@ -309,15 +432,36 @@ void LocalMap::requestExteriorMap(const MWWorld::CellStore* cell)
     int x = cell->getCell()->getGridX();
     int y = cell->getCell()->getGridY();
 
-    osg::BoundingSphere bound = mViewer->getSceneData()->getBound();
-    float zmin = bound.center().z() - bound.radius();
-    float zmax = bound.center().z() + bound.radius();
+    MapSegment& segment = mSegments[std::make_pair(x, y)];
 
-    osg::ref_ptr<osg::Camera> camera = createOrthographicCamera(x*mMapWorldSize + mMapWorldSize/2.f, y*mMapWorldSize + mMapWorldSize/2.f, mMapWorldSize, mMapWorldSize,
-                                                                osg::Vec3d(0,1,0), zmin, zmax);
-    setupRenderToTexture(camera, cell->getCell()->getGridX(), cell->getCell()->getGridY());
+    if (!segment.mMapTexture)
+    {
+        CachedMapMap::iterator cached = mCachedMaps.find(std::make_pair(x, y));
+        if (cached != mCachedMaps.end())
+        {
+            segment.mMapTexture = cached->second.mTexture;
+            segment.mMapSignature = cached->second.mSignature;
+            segment.mHasMapSignature = true;
+            mCachedMaps.erase(cached);
+        }
+    }
 
-    MapSegment& segment = mSegments[std::make_pair(cell->getCell()->getGridX(), cell->getCell()->getGridY())];
+    MapSignatureVisitor visitor;
+    bool hasSignature = cell->forEachConst(visitor);
+
+    if (!segment.mMapTexture || !hasSignature || !segment.mHasMapSignature || segment.mMapSignature != visitor.mHash)
+    {
+        osg::BoundingSphere bound = mViewer->getSceneData()->getBound();
+        float zmin = bound.center().z() - bound.radius();
+        float zmax = bound.center().z() + bound.radius();
+
+        osg::ref_ptr<osg::Camera> camera = createOrthographicCamera(x*mMapWorldSize + mMapWorldSize/2.f, y*mMapWorldSize + mMapWorldSize/2.f, mMapWorldSize, mMapWorldSize,
+                                                                    osg::Vec3d(0,1,0), zmin, zmax);
+        setupRenderToTexture(camera, x, y);
+
+        segment.mMapSignature = visitor.mHash;
+        segment.mHasMapSignature = hasSignature;
+    }
     if (!segment.mFogOfWarImage)
     {
         if (cell->getFog())
@@ -591,6 +735,8 @@ void LocalMap::updatePlayer (const osg::Vec3f& position, const osg::Quat& orient
 
 LocalMap::MapSegment::MapSegment()
     : mHasFogState(false)
+    , mMapSignature(0)
+    , mHasMapSignature(false)
 {
 }
 
@@ -4,6 +4,7 @@
 #include <set>
 #include <vector>
 #include <map>
+#include <deque>
 
 #include <osg/BoundingBox>
 #include <osg/Quat>
@@ -51,11 +52,14 @@ namespace MWRender
 
         /**
          * Request a map render for the given cells. Render textures will be immediately created and can be retrieved with the getMapTexture function.
+         * @note The rendering itself is queued, see cleanupCameras(). Exterior cells whose contents have not changed since their last render
+         * keep their current texture.
          */
         void requestMap (std::set<const MWWorld::CellStore*> cells);
 
         /**
-         * Remove map and fog textures for the given cell.
+         * Remove map and fog textures for the given cell. The map texture of an exterior cell is kept in a cache, to be reused
+         * when the cell is requested again.
          */
         void removeCell (MWWorld::CellStore* cell);
 
@@ -72,6 +76,7 @@ namespace MWRender
          * Removes cameras that have already been rendered. Should be called every frame to ensure that
          * we do not render the same map more than once. Note, this cleanup is difficult to implement in an
          * automated fashion, since we can't alter the scene graph structure from within an update callback.
+         * Also starts rendering the next queued maps, up to the "local map renders per frame" budget.
          */
         void cleanupCameras();
 
@@ -115,6 +120,17 @@ namespace MWRender
 
         CameraVector mCamerasPendingRemoval;
 
+        struct PendingRender
+        {
+            osg::ref_ptr<osg::Camera> mCamera;
+            osg::ref_ptr<osg::Texture2D> mTexture;
+        };
+
+        // cameras waiting for their turn to be rendered, in the order they were requested
+        std::deque<PendingRender> mPendingRenders;
+
+        int mRendersPerFrame;
+
         struct MapSegment
         {
             MapSegment();
@@ -130,11 +146,29 @@ namespace MWRender
             osg::ref_ptr<osg::Image> mFogOfWarImage;
 
             bool mHasFogState;
+
+            // hash of the cell contents mMapTexture was rendered from, only used for exteriors
+            size_t mMapSignature;
+            bool mHasMapSignature;
         };
 
         typedef std::map<std::pair<int, int>, MapSegment> SegmentMap;
         SegmentMap mSegments;
 
+        struct CachedMap
+        {
+            osg::ref_ptr<osg::Texture2D> mTexture;
+            size_t mSignature;
+            unsigned int mLastUsed;
+        };
+
+        // map textures of exterior cells that have been unloaded
+        typedef std::map<std::pair<int, int>, CachedMap> CachedMapMap;
+        CachedMapMap mCachedMaps;
+
+        unsigned int mCacheSize;
+        unsigned int mCacheTime;
+
         int mMapResolution;
 
         // the dynamic texture is a bottleneck, so don't set this too high
@@ -154,6 +188,12 @@ namespace MWRender
         osg::ref_ptr<osg::Camera> createOrthographicCamera(float left, float top, float width, float height, const osg::Vec3d& upVector, float zmin, float zmax);
         void setupRenderToTexture(osg::ref_ptr<osg::Camera> camera, int x, int y);
 
+        /// Drop the queued render of the given texture, if there is one.
+        /// @return Was a render dropped?
+        bool removePendingRender(osg::Texture2D* texture);
+
+        void cacheMap(const std::pair<int, int>& cell, const MapSegment& segment);
+
         bool mInterior;
         osg::BoundingBox mBounds;
     };
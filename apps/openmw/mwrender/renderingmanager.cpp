@@ -28,6 +28,7 @@
 #include <components/sceneutil/positionattitudetransform.hpp>
 #include <components/sceneutil/workqueue.hpp>
 #include <components/sceneutil/unrefqueue.hpp>
+#include <components/sceneutil/riggeometry.hpp>
 
 #include <components/terrain/terraingrid.hpp>
 
@@ -167,6 +168,13 @@ namespace MWRender
         , mFieldOfViewOverride(0.f)
         , mFieldOfViewOverridden(false)
     {
+        int skinningThreads = Settings::Manager::getInt("skinning threads", "General");
+        if (skinningThreads > 0)
+        {
+            mSkinningWorkQueue = new SceneUtil::WorkQueue(skinningThreads);
+            SceneUtil::RigGeometry::setSkinningWorkQueue(mSkinningWorkQueue.get());
+        }
+
         resourceSystem->getSceneManager()->setParticleSystemMask(MWRender::Mask_ParticleSystem);
         resourceSystem->getSceneManager()->setShaderPath(resourcePath + "/shaders");
         resourceSystem->getSceneManager()->setForceShaders(Settings::Manager::getBool("force shaders", "Shaders"));
@@ -199,7 +207,8 @@ namespace MWRender
         mTerrain.reset(new Terrain::TerrainGrid(sceneRoot, mResourceSystem, mViewer->getIncrementalCompileOperation(),
                                                 new TerrainStorage(mResourceSystem->getVFS(), Settings::Manager::getString("normal map pattern", "Shaders"), Settings::Manager::getBool("auto use terrain normal maps", "Shaders"),
                                                      Settings::Manager::getString("terrain specular map pattern", "Shaders"), Settings::Manager::getBool("auto use terrain specular maps", "Shaders")),
-                                                 Mask_Terrain, &mResourceSystem->getSceneManager()->getShaderManager(), mUnrefQueue.get()));
+                                                 Mask_Terrain, &mResourceSystem->getSceneManager()->getShaderManager(), mUnrefQueue.get(),
+                                                 Settings::Manager::getInt("terrain build threads", "Cells")));
 
         mCamera.reset(new Camera(mViewer->getCamera()));
 
@@ -256,6 +265,7 @@ namespace MWRender
 
     RenderingManager::~RenderingManager()
     {
+        SceneUtil::RigGeometry::setSkinningWorkQueue(NULL);
     }
 
     MWRender::Objects& RenderingManager::getObjects()
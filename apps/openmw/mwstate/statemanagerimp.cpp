@@ -11,6 +11,8 @@
 
 #include <components/settings/settings.hpp>
 
+#include <components/sceneutil/workqueue.hpp>
+
 #include <osg/Image>
 
 #include <osgDB/Registry>
@@ -40,6 +42,73 @@
 
 #include "../mwscript/globalscripts.hpp"
 
+namespace
+{
+    const MWState::Slot* findSlot(const MWState::Character* character, const boost::filesystem::path& path)
+    {
+        for (MWState::Character::SlotIterator it = character->begin(); it != character->end(); ++it)
+        {
+            if (it->mPath == path)
+                return &*it;
+        }
+        return NULL;
+    }
+}
+
+namespace MWState
+{
+    /// Writes a serialized saved game to a temporary file, then renames it over the slot's file, so that a failed
+    /// or interrupted write never trashes the existing save.
+    class WriteSaveWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        WriteSaveWorkItem(const boost::filesystem::path& path, std::string& data)
+            : mPath(path)
+        {
+            mData.swap(data);
+        }
+
+        virtual void doWork()
+        {
+            boost::filesystem::path tempPath = mPath;
+            tempPath += ".tmp";
+
+            try
+            {
+                {
+                    boost::filesystem::ofstream filestream (tempPath, std::ios::binary | std::ios::trunc);
+                    filestream.write(mData.data(), mData.size());
+                    filestream.close();
+
+                    if (filestream.fail())
+                        throw std::runtime_error("Write operation failed (file stream)");
+                }
+
+                boost::filesystem::rename(tempPath, mPath);
+            }
+            catch (const std::exception& e)
+            {
+                mError = e.what();
+
+                boost::system::error_code ec;
+                boost::filesystem::remove(tempPath, ec);
+            }
+
+            std::string().swap(mData);
+        }
+
+        const boost::filesystem::path& getPath() const { return mPath; }
+
+        /// Empty if the file was written successfully. Only valid once the work item is done.
+        const std::string& getError() const { return mError; }
+
+    private:
+        boost::filesystem::path mPath;
+        std::string mData;
+        std::string mError;
+    };
+}
+
 void MWState::StateManager::cleanup (bool force)
 {
     if (mState!=State_NoGame || force)
@@ -89,7 +158,51 @@ std::map<int, int> MWState::StateManager::buildContentFileIndexMap (const ESM::E
 MWState::StateManager::StateManager (const boost::filesystem::path& saves, const std::string& game)
 : mQuitRequest (false), mAskLoadRecent(false), mState (State_NoGame), mCharacterManager (saves, game), mTimePlayed (0)
 {
+    if (Settings::Manager::getBool("async file write", "Saves"))
+        mSaveQueue = new SceneUtil::WorkQueue(1);
+}
 
+MWState::StateManager::~StateManager()
+{
+    // the GUI is gone at this point, so only log the result
+    if (mPendingSave)
+    {
+        mPendingSave->waitTillDone();
+        if (!mPendingSave->getError().empty())
+            std::cerr << "Failed to save game: " << mPendingSave->getError() << std::endl;
+    }
+}
+
+void MWState::StateManager::finishPendingSave()
+{
+    if (!mPendingSave)
+        return;
+
+    osg::ref_ptr<WriteSaveWorkItem> save = mPendingSave;
+    mPendingSave = NULL;
+
+    save->waitTillDone();
+
+    if (save->getError().empty())
+        return;
+
+    std::stringstream error;
+    error << "Failed to save game: " << save->getError();
+
+    std::cerr << error.str() << std::endl;
+
+    std::vector<std::string> buttons;
+    buttons.push_back("#{sOk}");
+    MWBase::Environment::get().getWindowManager()->interactiveMessageBox(error.str(), buttons);
+
+    // If no file was written, clean up the slot
+    if (!boost::filesystem::exists(save->getPath()))
+    {
+        Character* character = getCurrentCharacter(false);
+        const Slot* slot = character ? findSlot(character, save->getPath()) : NULL;
+        if (slot)
+            character->deleteSlot(slot);
+    }
 }
 
 void MWState::StateManager::requestQuit()
@@ -172,6 +285,16 @@ void MWState::StateManager::endGame()
 
 void MWState::StateManager::saveGame (const std::string& description, const Slot *slot)
 {
+    // Saves are written in order, so a pending write can't replace this one's file afterwards
+    if (mPendingSave)
+    {
+        // a failed save deletes its slot, which moves the other slots around
+        boost::filesystem::path slotPath = slot ? slot->mPath : boost::filesystem::path();
+        finishPendingSave();
+        if (slot)
+            slot = findSlot(getCurrentCharacter(), slotPath);
+    }
+
     try
     {
         ESM::SavedGame profile;
@@ -250,6 +373,9 @@ void MWState::StateManager::saveGame (const std::string& description, const Slot
         slot->mProfile.save (writer);
         writer.endRecord (ESM::REC_SAVE);
 
+        // The profile stays uncompressed, it is read for every slot when listing the saved games
+        writer.setCompressed(Settings::Manager::getBool("compress", "Saves"));
+
         MWBase::Environment::get().getJournal()->write (writer, listener);
         MWBase::Environment::get().getDialogueManager()->write (writer, listener);
         MWBase::Environment::get().getWorld()->write (writer, listener);
@@ -266,15 +392,21 @@ void MWState::StateManager::saveGame (const std::string& description, const Slot
         if (stream.fail())
             throw std::runtime_error("Write operation failed (memory stream)");
 
-        // All good, write to file
-        boost::filesystem::ofstream filestream (slot->mPath, std::ios::binary);
-        filestream << stream.rdbuf();
-
-        if (filestream.fail())
-            throw std::runtime_error("Write operation failed (file stream)");
+        // All good, write to file. The serialized data is all the work item needs, so the game can go on meanwhile.
+        boost::filesystem::path path = slot->mPath;
+        std::string data = stream.str();
+        mPendingSave = new WriteSaveWorkItem(path, data);
+        if (mSaveQueue)
+            mSaveQueue->addWorkItem(mPendingSave);
+        else
+        {
+            mPendingSave->doWork();
+            finishPendingSave();
+        }
 
+        // set right away, since the settings may be written on quit before the file is
         Settings::Manager::setString ("character", "Saves",
-            slot->mPath.parent_path().filename().string());
+            path.parent_path().filename().string());
     }
     catch (const std::exception& e)
     {
@@ -319,6 +451,8 @@ void MWState::StateManager::quickSave (std::string name)
 
 void MWState::StateManager::loadGame(const std::string& filepath)
 {
+    finishPendingSave();
+
     for (CharacterIterator it = mCharacterManager.begin(); it != mCharacterManager.end(); ++it)
     {
         const MWState::Character& character = *it;
@@ -350,6 +484,8 @@ void MWState::StateManager::loadGame(const std::string& filepath)
 
 void MWState::StateManager::loadGame (const Character *character, const std::string& filepath)
 {
+    finishPendingSave();
+
     try
     {
         cleanup();
@@ -525,6 +661,15 @@ void MWState::StateManager::quickLoad()
 
 void MWState::StateManager::deleteGame(const MWState::Character *character, const MWState::Slot *slot)
 {
+    if (mPendingSave)
+    {
+        boost::filesystem::path slotPath = slot->mPath;
+        finishPendingSave();
+        slot = findSlot(character, slotPath);
+        if (!slot)
+            return;
+    }
+
     mCharacterManager.deleteSlot(character, slot);
 }
 
@@ -550,6 +695,9 @@ void MWState::StateManager::update (float duration)
 {
     mTimePlayed += duration;
 
+    if (mPendingSave && mPendingSave->isDone())
+        finishPendingSave();
+
     // Note: It would be nicer to trigger this from InputManager, i.e. the very beginning of the frame update.
     if (mAskLoadRecent)
     {
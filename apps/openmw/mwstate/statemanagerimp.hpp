@@ -7,10 +7,19 @@
 
 #include <boost/filesystem/path.hpp>
 
+#include <osg/ref_ptr>
+
 #include "charactermanager.hpp"
 
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
 namespace MWState
 {
+    class WriteSaveWorkItem;
+
     class StateManager : public MWBase::StateManager
     {
             bool mQuitRequest;
@@ -19,8 +28,14 @@ namespace MWState
             CharacterManager mCharacterManager;
             double mTimePlayed;
 
+            osg::ref_ptr<SceneUtil::WorkQueue> mSaveQueue;
+            osg::ref_ptr<WriteSaveWorkItem> mPendingSave;
+
         private:
 
+            /// Wait for the save file that is being written in the background, if any, and report its result.
+            void finishPendingSave();
+
             void cleanup (bool force = false);
 
             bool verifyProfile (const ESM::SavedGame& profile) const;
@@ -33,6 +48,8 @@ namespace MWState
 
             StateManager (const boost::filesystem::path& saves, const std::string& game);
 
+            virtual ~StateManager();
+
             virtual void requestQuit();
 
             virtual bool hasQuitRequest() const;
@@ -55,6 +72,8 @@ namespace MWState
             ///< Write a saved game to \a slot or create a new slot if \a slot == 0.
             ///
             /// \note Slot must belong to the current character.
+            /// \note The game state is serialized right away, but the file may be written in the background
+            /// (see "async file write" in the Saves section of the settings). Write errors are reported from update().
 
             ///Saves a file, using supplied filename, overwritting if needed
             /** This is mostly used for quicksaving and autosaving, for they use the same name over and over again
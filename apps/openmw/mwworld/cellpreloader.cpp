@@ -178,7 +178,7 @@ namespace MWWorld
         mPreloadCells.clear();
     }
 
-    void CellPreloader::preload(CellStore *cell, double timestamp)
+    void CellPreloader::preload(CellStore *cell, double timestamp, SceneUtil::WorkQueue::Priority priority)
     {
         if (!mWorkQueue)
         {
@@ -196,6 +196,17 @@ namespace MWWorld
         {
             // already preloaded, nothing to do other than updating the timestamp
             found->second.mTimeStamp = timestamp;
+
+            // still waiting in a lower priority queue, e.g. a speculative preload for a cell that we're now about to enter
+            // once a worker has started the preload, letting it finish is cheaper than starting over
+            if (priority < found->second.mPriority && found->second.mWorkItem->abortIfNotStarted())
+            {
+                osg::ref_ptr<PreloadItem> item (new PreloadItem(cell, mResourceSystem->getSceneManager(), mBulletShapeManager, mResourceSystem->getKeyframeManager(), mTerrain));
+                mWorkQueue->addWorkItem(item, priority);
+
+                found->second.mWorkItem = item;
+                found->second.mPriority = priority;
+            }
             return;
         }
 
@@ -213,18 +224,26 @@ namespace MWWorld
                 }
             }
 
-            mPreloadCells.erase(oldestCell);
+            erase(oldestCell);
         }
 
         osg::ref_ptr<PreloadItem> item (new PreloadItem(cell, mResourceSystem->getSceneManager(), mBulletShapeManager, mResourceSystem->getKeyframeManager(), mTerrain));
-        mWorkQueue->addWorkItem(item);
+        mWorkQueue->addWorkItem(item, priority);
 
-        mPreloadCells[cell] = PreloadEntry(timestamp, item);
+        mPreloadCells[cell] = PreloadEntry(timestamp, item, priority);
     }
 
     void CellPreloader::notifyLoaded(CellStore *cell)
     {
-        mPreloadCells.erase(cell);
+        PreloadMap::iterator found = mPreloadCells.find(cell);
+        if (found != mPreloadCells.end())
+            erase(found);
+    }
+
+    void CellPreloader::erase(PreloadMap::iterator it)
+    {
+        it->second.mWorkItem->abort();
+        mPreloadCells.erase(it);
     }
 
     void CellPreloader::updateCache(double timestamp)
@@ -232,13 +251,13 @@ namespace MWWorld
         for (PreloadMap::iterator it = mPreloadCells.begin(); it != mPreloadCells.end();)
         {
             if (mPreloadCells.size() >= mMinCacheSize && it->second.mTimeStamp < timestamp - mExpiryDelay)
-                mPreloadCells.erase(it++);
+                erase(it++);
             else
                 ++it;
         }
 
         // the resource cache is cleared from the worker thread so that we're not holding up the main thread with delete operations
-        mWorkQueue->addWorkItem(new UpdateCacheItem(mResourceSystem, mTerrain, timestamp));
+        mWorkQueue->addWorkItem(new UpdateCacheItem(mResourceSystem, mTerrain, timestamp), SceneUtil::WorkQueue::Priority_Low);
     }
 
     void CellPreloader::setExpiryDelay(double expiryDelay)
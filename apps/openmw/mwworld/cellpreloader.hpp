@@ -28,7 +28,8 @@ namespace MWWorld
 
         /// Ask a background thread to preload rendering meshes and collision shapes for objects in this cell.
         /// @note The cell itself must be in State_Loaded or State_Preloaded.
-        void preload(MWWorld::CellStore* cell, double timestamp);
+        /// @param priority If the cell is already queued at a lower priority, its preload is moved up to this priority.
+        void preload(MWWorld::CellStore* cell, double timestamp, SceneUtil::WorkQueue::Priority priority=SceneUtil::WorkQueue::Priority_Normal);
 
         void notifyLoaded(MWWorld::CellStore* cell);
 
@@ -57,21 +58,27 @@ namespace MWWorld
 
         struct PreloadEntry
         {
-            PreloadEntry(double timestamp, osg::ref_ptr<SceneUtil::WorkItem> workItem)
+            PreloadEntry(double timestamp, osg::ref_ptr<SceneUtil::WorkItem> workItem, SceneUtil::WorkQueue::Priority priority)
                 : mTimeStamp(timestamp)
                 , mWorkItem(workItem)
+                , mPriority(priority)
             {
             }
             PreloadEntry()
                 : mTimeStamp(0.0)
+                , mPriority(SceneUtil::WorkQueue::Priority_Normal)
             {
             }
 
             double mTimeStamp;
             osg::ref_ptr<SceneUtil::WorkItem> mWorkItem;
+            SceneUtil::WorkQueue::Priority mPriority;
         };
         typedef std::map<const MWWorld::CellStore*, PreloadEntry> PreloadMap;
 
+        /// Remove the entry, cancelling its preload if it hasn't started yet.
+        void erase(PreloadMap::iterator it);
+
         // Cells that are currently being preloaded, or have already finished preloading
         PreloadMap mPreloadCells;
     };
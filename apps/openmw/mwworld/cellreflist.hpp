@@ -1,8 +1,7 @@
 #ifndef GAME_MWWORLD_CELLREFLIST_H
 #define GAME_MWWORLD_CELLREFLIST_H
 
-#include <list>
-
+#include "chunkedvector.hpp"
 #include "livecellref.hpp"
 
 namespace MWWorld
@@ -12,7 +11,7 @@ namespace MWWorld
     struct CellRefList
     {
         typedef LiveCellRef<X> LiveRef;
-        typedef std::list<LiveRef> List;
+        typedef ChunkedVector<LiveRef> List;
         List mList;
 
         /// Search for the given reference in the given reclist from
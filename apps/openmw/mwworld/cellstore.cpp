@@ -178,7 +178,7 @@ namespace MWWorld
 
         if (const X *ptr = store.search (ref.mRefID))
         {
-            typename std::list<LiveRef>::iterator iter =
+            typename List::iterator iter =
                 std::find(mList.begin(), mList.end(), ref.mRefNum);
 
             LiveRef liveCellRef (ref, ptr);
@@ -437,7 +437,7 @@ namespace MWWorld
 
             // TODO: the pathgrid graph only needs to be loaded for active cells, so move this somewhere else.
             // In a simple test, loading the graph for all cells in MW + expansions took 200 ms
-            mPathgridGraph.load(this);
+            mPathgridGraph.load(mStore.get<ESM::Pathgrid>().search(*mCell));
         }
     }
 
@@ -874,9 +874,10 @@ namespace MWWorld
         return mPathgridGraph.isPointConnected(start, end);
     }
 
-    std::list<ESM::Pathgrid::Point> CellStore::aStarSearch(const int start, const int end) const
+    bool CellStore::aStarSearch(const int start, const int end, MWMechanics::PathgridPath& path,
+                                MWMechanics::AStarScratch& scratch) const
     {
-        return mPathgridGraph.aStarSearch(start, end);
+        return mPathgridGraph.findPath(start, end, path, scratch);
     }
 
     void CellStore::setFog(ESM::FogState *fog)
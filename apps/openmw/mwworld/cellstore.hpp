@@ -323,7 +323,7 @@ namespace MWWorld
                 for (MovedRefTracker::const_iterator it = mMovedHere.begin(); it != mMovedHere.end(); ++it)
                 {
                     LiveCellRefBase* base = it->first;
-                    if (dynamic_cast<LiveCellRef<T>*>(base))
+                    if (LiveCellRef<T>::dynamicCast(base))
                         if (!visitor(MWWorld::Ptr(base, this)))
                             return false;
                 }
@@ -370,7 +370,8 @@ namespace MWWorld
 
             bool isPointConnected(const int start, const int end) const;
 
-            std::list<ESM::Pathgrid::Point> aStarSearch(const int start, const int end) const;
+            bool aStarSearch(const int start, const int end, MWMechanics::PathgridPath& path,
+                             MWMechanics::AStarScratch& scratch) const;
 
         private:
 
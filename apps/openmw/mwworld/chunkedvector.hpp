@@ -0,0 +1,223 @@
+#ifndef GAME_MWWORLD_CHUNKEDVECTOR_H
+#define GAME_MWWORLD_CHUNKEDVECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <vector>
+
+namespace MWWorld
+{
+    /// \brief Sequence container that stores its elements in contiguous chunks.
+    ///
+    /// Elements never move once inserted, so pointers, references and iterators to them stay valid
+    /// until the container is cleared or destroyed, like with a std::list. Unlike a std::list, iterating
+    /// walks memory linearly. Chunks start small and grow up to MaxChunkSize elements, so that the many
+    /// containers holding only a few elements stay cheap.
+    /// \note Elements can only be appended, never erased individually.
+    template <typename T>
+    class ChunkedVector
+    {
+            static const size_t MinChunkSize = 4;
+            static const size_t MaxChunkSize = 256;
+
+            struct Chunk
+            {
+                T* mData;
+                size_t mSize;
+                size_t mCapacity;
+            };
+
+            typedef std::vector<Chunk> Chunks;
+
+            template <typename Value>
+            class Iterator
+            {
+                    const Chunks* mChunks;
+                    size_t mChunk;
+                    Value* mPtr;
+
+                    friend class ChunkedVector;
+
+                    template <typename OtherValue>
+                    friend class Iterator;
+
+                    Iterator (const Chunks* chunks, size_t chunk, Value* ptr)
+                        : mChunks (chunks), mChunk (chunk), mPtr (ptr) {}
+
+                public:
+
+                    typedef std::bidirectional_iterator_tag iterator_category;
+                    typedef T value_type;
+                    typedef std::ptrdiff_t difference_type;
+                    typedef Value* pointer;
+                    typedef Value& reference;
+
+                    Iterator() : mChunks (NULL), mChunk (0), mPtr (NULL) {}
+
+                    template <typename OtherValue>
+                    Iterator (const Iterator<OtherValue>& other)
+                        : mChunks (other.mChunks), mChunk (other.mChunk), mPtr (other.mPtr) {}
+
+                    Value& operator*() const { return *mPtr; }
+
+                    Value* operator->() const { return mPtr; }
+
+                    Iterator& operator++()
+                    {
+                        ++mPtr;
+                        const Chunk& chunk = (*mChunks)[mChunk];
+                        if (mPtr == chunk.mData + chunk.mSize && mChunk+1 < mChunks->size())
+                        {
+                            ++mChunk;
+                            mPtr = (*mChunks)[mChunk].mData;
+                        }
+                        return *this;
+                    }
+
+                    Iterator operator++ (int)
+                    {
+                        Iterator iter (*this);
+                        ++*this;
+                        return iter;
+                    }
+
+                    Iterator& operator--()
+                    {
+                        if (mPtr == (*mChunks)[mChunk].mData)
+                        {
+                            --mChunk;
+                            const Chunk& chunk = (*mChunks)[mChunk];
+                            mPtr = chunk.mData + chunk.mSize;
+                        }
+                        --mPtr;
+                        return *this;
+                    }
+
+                    Iterator operator-- (int)
+                    {
+                        Iterator iter (*this);
+                        --*this;
+                        return iter;
+                    }
+
+                    template <typename OtherValue>
+                    bool operator== (const Iterator<OtherValue>& other) const { return mPtr == other.mPtr; }
+
+                    template <typename OtherValue>
+                    bool operator!= (const Iterator<OtherValue>& other) const { return mPtr != other.mPtr; }
+            };
+
+            Chunks mChunks;
+            size_t mSize;
+
+            void reserveChunk (size_t capacity)
+            {
+                Chunk chunk;
+                chunk.mData = static_cast<T*> (::operator new (capacity * sizeof (T)));
+                chunk.mSize = 0;
+                chunk.mCapacity = capacity;
+                mChunks.push_back (chunk);
+            }
+
+        public:
+
+            typedef T value_type;
+            typedef Iterator<T> iterator;
+            typedef Iterator<const T> const_iterator;
+
+            ChunkedVector() : mSize (0) {}
+
+            ChunkedVector (const ChunkedVector& other) : mSize (0)
+            {
+                if (!other.empty())
+                {
+                    // a single chunk, the size of the copy is rarely going to change much
+                    reserveChunk (other.size() < MinChunkSize ? MinChunkSize : other.size());
+                    for (const_iterator iter (other.begin()); iter!=other.end(); ++iter)
+                        push_back (*iter);
+                }
+            }
+
+            ~ChunkedVector()
+            {
+                clear();
+            }
+
+            ChunkedVector& operator= (const ChunkedVector& other)
+            {
+                if (this != &other)
+                {
+                    ChunkedVector copy (other);
+                    mChunks.swap (copy.mChunks);
+                    std::swap (mSize, copy.mSize);
+                }
+                return *this;
+            }
+
+            void push_back (const T& value)
+            {
+                if (mChunks.empty())
+                    reserveChunk (MinChunkSize);
+                else if (mChunks.back().mSize == mChunks.back().mCapacity)
+                {
+                    size_t capacity = mChunks.back().mCapacity * 2;
+                    reserveChunk (capacity < MaxChunkSize ? capacity : MaxChunkSize);
+                }
+
+                Chunk& chunk = mChunks.back();
+                new (chunk.mData + chunk.mSize) T (value);
+                ++chunk.mSize;
+                ++mSize;
+            }
+
+            void clear()
+            {
+                for (typename Chunks::iterator chunk (mChunks.begin()); chunk!=mChunks.end(); ++chunk)
+                {
+                    for (size_t i=0; i<chunk->mSize; ++i)
+                        chunk->mData[i].~T();
+                    ::operator delete (chunk->mData);
+                }
+                mChunks.clear();
+                mSize = 0;
+            }
+
+            size_t size() const { return mSize; }
+
+            bool empty() const { return mSize == 0; }
+
+            T& front() { return *mChunks.front().mData; }
+            const T& front() const { return *mChunks.front().mData; }
+
+            T& back() { return mChunks.back().mData[mChunks.back().mSize-1]; }
+            const T& back() const { return mChunks.back().mData[mChunks.back().mSize-1]; }
+
+            iterator begin()
+            {
+                return iterator (&mChunks, 0, mChunks.empty() ? NULL : mChunks.front().mData);
+            }
+
+            const_iterator begin() const
+            {
+                return const_iterator (&mChunks, 0, mChunks.empty() ? NULL : mChunks.front().mData);
+            }
+
+            iterator end()
+            {
+                if (mChunks.empty())
+                    return iterator (&mChunks, 0, NULL);
+                return iterator (&mChunks, mChunks.size()-1, mChunks.back().mData + mChunks.back().mSize);
+            }
+
+            const_iterator end() const
+            {
+                if (mChunks.empty())
+                    return const_iterator (&mChunks, 0, NULL);
+                return const_iterator (&mChunks, mChunks.size()-1, mChunks.back().mData + mChunks.back().mSize);
+            }
+    };
+}
+
+#endif
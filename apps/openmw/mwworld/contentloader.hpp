@@ -21,6 +21,11 @@ struct ContentLoader
     {
     }
 
+    /// Announce a file that load() will be called on later, so that loaders may start work on it in the background.
+    virtual void prepare(const boost::filesystem::path& filepath, int index)
+    {
+    }
+
     virtual void load(const boost::filesystem::path& filepath, int& index)
     {
       std::cout << "Loading content file " << filepath.string() << std::endl;
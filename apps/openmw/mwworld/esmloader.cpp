@@ -1,18 +1,106 @@
 #include "esmloader.hpp"
 #include "esmstore.hpp"
 
+#include <iostream>
+
 #include <components/esm/esmreader.hpp>
+#include <components/sceneutil/workqueue.hpp>
 
 namespace MWWorld
 {
 
+/// Decodes a content file in a worker thread, using a reader and encoder of its own.
+class StageContentFileWorkItem : public SceneUtil::WorkItem
+{
+public:
+  StageContentFileWorkItem(const MWWorld::ESMStore& store, const std::string& filepath, int index, const ToUTF8::Utf8Encoder* encoder)
+    : mStore(store)
+    , mFilePath(filepath)
+    , mIndex(index)
+    // the encoder's output buffer is not thread safe, use a copy
+    , mEncoder(encoder ? new ToUTF8::Utf8Encoder(*encoder) : NULL)
+    , mStaged(false)
+  {
+  }
+
+  ~StageContentFileWorkItem()
+  {
+    delete mEncoder;
+  }
+
+  virtual void doWork()
+  {
+    ESM::ESMReader esm;
+    esm.setEncoder(mEncoder);
+    esm.setIndex(mIndex);
+    try
+    {
+      esm.open(mFilePath, true);
+      mStore.stage(esm, mStagedFile);
+      mStaged = true;
+    }
+    catch (std::exception& e)
+    {
+      // the file is loaded again without staging, which reports the error the usual way
+      std::cerr << "Warning: failed to decode " << mFilePath << " in the background: " << e.what() << std::endl;
+    }
+  }
+
+  /// Did the file get staged? If not, it needs to be loaded without staging.
+  bool isStaged() const
+  {
+    return mStaged;
+  }
+
+  MWWorld::StagedContentFile& getStagedFile()
+  {
+    return mStagedFile;
+  }
+
+private:
+  const MWWorld::ESMStore& mStore;
+  std::string mFilePath;
+  int mIndex;
+  ToUTF8::Utf8Encoder* mEncoder;
+  MWWorld::StagedContentFile mStagedFile;
+  bool mStaged;
+};
+
 EsmLoader::EsmLoader(MWWorld::ESMStore& store, std::vector<ESM::ESMReader>& readers,
-  ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener)
+  ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener, int numThreads)
   : ContentLoader(listener)
   , mEsm(readers)
   , mStore(store)
   , mEncoder(encoder)
+  , mNumThreads(numThreads)
+{
+  if (mNumThreads > 0)
+    mWorkQueue = new SceneUtil::WorkQueue(mNumThreads);
+}
+
+EsmLoader::~EsmLoader()
+{
+  for (std::map<int, osg::ref_ptr<StageContentFileWorkItem> >::iterator it = mStaging.begin(); it != mStaging.end(); ++it)
+    it->second->abort();
+}
+
+void EsmLoader::prepare(const boost::filesystem::path& filepath, int index)
+{
+  if (mWorkQueue)
+    mPrepared[index] = filepath;
+}
+
+void EsmLoader::stageAhead(int index)
 {
+  // Keep a few files ahead of the one being merged, rather than decoding the whole load order into memory up front
+  while (!mPrepared.empty() && mPrepared.begin()->first <= index + mNumThreads)
+  {
+    std::map<int, boost::filesystem::path>::iterator next = mPrepared.begin();
+    osg::ref_ptr<StageContentFileWorkItem> item (new StageContentFileWorkItem(mStore, next->second.string(), next->first, mEncoder));
+    mWorkQueue->addWorkItem(item);
+    mStaging[next->first] = item;
+    mPrepared.erase(next);
+  }
 }
 
 void EsmLoader::load(const boost::filesystem::path& filepath, int& index)
@@ -23,9 +111,28 @@ void EsmLoader::load(const boost::filesystem::path& filepath, int& index)
   lEsm.setEncoder(mEncoder);
   lEsm.setIndex(index);
   lEsm.setGlobalReaderList(&mEsm);
-  lEsm.open(filepath.string());
+  lEsm.open(filepath.string(), true);
   mEsm[index] = lEsm;
-  mStore.load(mEsm[index], &mListener);
+
+  if (mWorkQueue)
+  {
+    mPrepared.erase(index);
+    stageAhead(index);
+  }
+
+  osg::ref_ptr<StageContentFileWorkItem> item;
+  std::map<int, osg::ref_ptr<StageContentFileWorkItem> >::iterator staging = mStaging.find(index);
+  if (staging != mStaging.end())
+  {
+    item = staging->second;
+    mStaging.erase(staging);
+    item->waitTillDone();
+  }
+
+  if (item && item->isStaged())
+    mStore.load(mEsm[index], &mListener, item->getStagedFile());
+  else
+    mStore.load(mEsm[index], &mListener);
 }
 
 } /* namespace MWWorld */
@@ -2,6 +2,9 @@
 #define ESMLOADER_HPP
 
 #include <vector>
+#include <map>
+
+#include <osg/ref_ptr>
 
 #include "contentloader.hpp"
 
@@ -15,22 +18,43 @@ namespace ESM
     class ESMReader;
 }
 
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
 namespace MWWorld
 {
 
 class ESMStore;
+class StageContentFileWorkItem;
 
 struct EsmLoader : public ContentLoader
 {
+    /// @param numThreads Number of background threads decoding upcoming content files while the current one is merged into the store.
+    /// 0 loads everything in the calling thread.
     EsmLoader(MWWorld::ESMStore& store, std::vector<ESM::ESMReader>& readers,
-      ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener);
+      ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener, int numThreads=0);
+    ~EsmLoader();
+
+    void prepare(const boost::filesystem::path& filepath, int index);
 
     void load(const boost::filesystem::path& filepath, int& index);
 
     private:
+      /// Start decoding the prepared files that are coming up after the given index.
+      void stageAhead(int index);
+
       std::vector<ESM::ESMReader>& mEsm;
       MWWorld::ESMStore& mStore;
       ToUTF8::Utf8Encoder* mEncoder;
+
+      int mNumThreads;
+      osg::ref_ptr<SceneUtil::WorkQueue> mWorkQueue;
+
+      // Files that were prepared, but not handed to the work queue yet
+      std::map<int, boost::filesystem::path> mPrepared;
+      std::map<int, osg::ref_ptr<StageContentFileWorkItem> > mStaging;
 };
 
 } /* namespace MWWorld */
@@ -27,11 +27,15 @@ static bool isCacheableRecord(int id)
     return false;
 }
 
-void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
+StagedContentFile::~StagedContentFile()
 {
-    listener->setProgressRange(1000);
+    for (std::vector<Entry>::iterator it = mEntries.begin(); it != mEntries.end(); ++it)
+        delete it->mRecord;
+}
 
-    ESM::Dialogue *dialogue = 0;
+void ESMStore::prepareLoad(ESM::ESMReader &esm, Loading::Listener* listener)
+{
+    listener->setProgressRange(1000);
 
     // Land texture loading needs to use a separate internal store for each plugin.
     // We set the number of plugins here to avoid continual resizes during loading,
@@ -66,6 +70,60 @@ void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
         }
         mast.index = index;
     }
+}
+
+void ESMStore::loadRecord(ESM::ESMReader &esm, ESM::NAME n, ESM::Dialogue *&dialogue)
+{
+    // Look up the record type.
+    std::map<int, StoreBase *>::iterator it = mStores.find(n.val);
+
+    if (it == mStores.end()) {
+        if (n.val == ESM::REC_INFO) {
+            if (dialogue)
+            {
+                dialogue->readInfo(esm, esm.getIndex() != 0);
+            }
+            else
+            {
+                std::cerr << "error: info record without dialog" << std::endl;
+                esm.skipRecord();
+            }
+        } else if (n.val == ESM::REC_MGEF) {
+            mMagicEffects.load (esm);
+        } else if (n.val == ESM::REC_SKIL) {
+            mSkills.load (esm);
+        }
+        else if (n.val==ESM::REC_FILT || n.val == ESM::REC_DBGP)
+        {
+            // ignore project file only records
+            esm.skipRecord();
+        }
+        else {
+            std::stringstream error;
+            error << "Unknown record: " << n.toString();
+            throw std::runtime_error(error.str());
+        }
+    } else {
+        RecordId id = it->second->load(esm);
+        if (id.mIsDeleted)
+        {
+            it->second->eraseStatic(id.mId);
+            return;
+        }
+
+        if (n.val==ESM::REC_DIAL) {
+            dialogue = const_cast<ESM::Dialogue*>(mDialogs.find(id.mId));
+        } else {
+            dialogue = 0;
+        }
+    }
+}
+
+void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
+{
+    prepareLoad(esm, listener);
+
+    ESM::Dialogue *dialogue = 0;
 
     // Loop through all records
     while(esm.hasMoreRecs())
@@ -73,50 +131,76 @@ void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
         ESM::NAME n = esm.getRecName();
         esm.getRecHeader();
 
-        // Look up the record type.
-        std::map<int, StoreBase *>::iterator it = mStores.find(n.val);
+        loadRecord(esm, n, dialogue);
 
-        if (it == mStores.end()) {
-            if (n.val == ESM::REC_INFO) {
-                if (dialogue)
-                {
-                    dialogue->readInfo(esm, esm.getIndex() != 0);
-                }
-                else
-                {
-                    std::cerr << "error: info record without dialog" << std::endl;
-                    esm.skipRecord();
-                }
-            } else if (n.val == ESM::REC_MGEF) {
-                mMagicEffects.load (esm);
-            } else if (n.val == ESM::REC_SKIL) {
-                mSkills.load (esm);
-            }
-            else if (n.val==ESM::REC_FILT || n.val == ESM::REC_DBGP)
-            {
-                // ignore project file only records
+        listener->setProgress(static_cast<size_t>(esm.getFileOffset() / (float)esm.getFileSize() * 1000));
+    }
+}
+
+void ESMStore::stage(ESM::ESMReader &esm, StagedContentFile &staged) const
+{
+    try
+    {
+        while(esm.hasMoreRecs())
+        {
+            StagedContentFile::Entry entry;
+            entry.mContext = esm.getContext();
+
+            ESM::NAME n = esm.getRecName();
+            esm.getRecHeader();
+
+            entry.mType = n.val;
+            entry.mRecord = NULL;
+
+            std::map<int, StoreBase *>::const_iterator it = mStores.find(n.val);
+            if (it != mStores.end())
+                entry.mRecord = it->second->stage(esm);
+
+            if (!entry.mRecord)
                 esm.skipRecord();
-            }
-            else {
-                std::stringstream error;
-                error << "Unknown record: " << n.toString();
-                throw std::runtime_error(error.str());
-            }
-        } else {
-            RecordId id = it->second->load(esm);
-            if (id.mIsDeleted)
-            {
-                it->second->eraseStatic(id.mId);
-                continue;
-            }
 
-            if (n.val==ESM::REC_DIAL) {
-                dialogue = const_cast<ESM::Dialogue*>(mDialogs.find(id.mId));
-            } else {
+            entry.mOffset = esm.getFileOffset();
+            staged.mEntries.push_back(entry);
+        }
+    }
+    catch (std::exception& e)
+    {
+        staged.mError = e.what();
+    }
+}
+
+void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener, StagedContentFile &staged)
+{
+    if (!staged.mError.empty())
+        throw std::runtime_error(staged.mError);
+
+    prepareLoad(esm, listener);
+
+    ESM::Dialogue *dialogue = 0;
+
+    // Merge the records in the order they appear in the file, the result has to be the same as with load()
+    for (std::vector<StagedContentFile::Entry>::iterator entry = staged.mEntries.begin(); entry != staged.mEntries.end(); ++entry)
+    {
+        if (entry->mRecord)
+        {
+            StoreBase* store = mStores[entry->mType];
+            RecordId id = store->merge(*entry->mRecord);
+            if (id.mIsDeleted)
+                store->eraseStatic(id.mId);
+            else
                 dialogue = 0;
-            }
         }
-        listener->setProgress(static_cast<size_t>(esm.getFileOffset() / (float)esm.getFileSize() * 1000));
+        else
+        {
+            esm.restoreContext(entry->mContext);
+
+            ESM::NAME n = esm.getRecName();
+            esm.getRecHeader();
+
+            loadRecord(esm, n, dialogue);
+        }
+
+        listener->setProgress(static_cast<size_t>(entry->mOffset / (float)esm.getFileSize() * 1000));
     }
 }
 
@@ -5,6 +5,7 @@
 #include <stdexcept>
 
 #include <components/esm/records.hpp>
+#include <components/esm/esmcommon.hpp>
 #include "store.hpp"
 
 namespace Loading
@@ -14,6 +15,33 @@ namespace Loading
 
 namespace MWWorld
 {
+    /// @brief The records of a content file, decoded by ESMStore::stage() ahead of being merged by ESMStore::load().
+    class StagedContentFile
+    {
+    public:
+        StagedContentFile() {}
+        ~StagedContentFile();
+
+    private:
+        struct Entry
+        {
+            int mType;
+            StagedRecord *mRecord; // NULL if the record needs to be loaded from mContext instead
+            ESM::ESM_Context mContext;
+            size_t mOffset; // for progress reporting
+        };
+
+        std::vector<Entry> mEntries;
+
+        // Set if staging failed, to be reported by the loading thread
+        std::string mError;
+
+        StagedContentFile(const StagedContentFile&);
+        StagedContentFile& operator=(const StagedContentFile&);
+
+        friend class ESMStore;
+    };
+
     class ESMStore
     {
         Store<ESM::Activator>       mActivators;
@@ -74,6 +102,9 @@ namespace MWWorld
 
         unsigned int mDynamicCount;
 
+        void prepareLoad(ESM::ESMReader &esm, Loading::Listener* listener);
+        void loadRecord(ESM::ESMReader &esm, ESM::NAME name, ESM::Dialogue *&dialogue);
+
     public:
         /// \todo replace with SharedIterator<StoreBase>
         typedef std::map<int, StoreBase *>::const_iterator iterator;
@@ -160,6 +191,17 @@ namespace MWWorld
 
         void load(ESM::ESMReader &esm, Loading::Listener* listener);
 
+        /// Decode the records of a content file that don't depend on the rest of the load order, so they can be
+        /// merged quickly by the load() overload below. Doesn't modify the ESMStore and may be called from a background thread
+        /// while other content files are being loaded.
+        /// @param esm A reader of its own, opened on the content file.
+        /// @note Errors are reported by load(), not thrown.
+        void stage(ESM::ESMReader &esm, StagedContentFile &staged) const;
+
+        /// Load a content file using the records decoded by stage(). Has the same result as load() without staging.
+        /// @param esm The content file's reader in the global reader list.
+        void load(ESM::ESMReader &esm, Loading::Listener* listener, StagedContentFile &staged);
+
         template <class T>
         const Store<T> &get() const {
             throw std::runtime_error("Storage for this type not exist");
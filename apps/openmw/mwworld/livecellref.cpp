@@ -11,8 +11,8 @@
 #include "class.hpp"
 #include "esmstore.hpp"
 
-MWWorld::LiveCellRefBase::LiveCellRefBase(const std::string& type, const ESM::CellRef &cref)
-  : mClass(&Class::get(type)), mRef(cref), mData(cref)
+MWWorld::LiveCellRefBase::LiveCellRefBase(const std::string& type, const void *typeTag, const ESM::CellRef &cref)
+  : mClass(&Class::get(type)), mType(typeTag), mRef(cref), mData(cref)
 {
 }
 
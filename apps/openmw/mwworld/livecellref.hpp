@@ -1,6 +1,7 @@
 #ifndef GAME_MWWORLD_LIVECELLREF_H
 #define GAME_MWWORLD_LIVECELLREF_H
 
+#include <cassert>
 #include <typeinfo>
 
 #include "cellref.hpp"
@@ -23,6 +24,9 @@ namespace MWWorld
     {
         const Class *mClass;
 
+        /// Identifies the LiveCellRef<X> this is, see LiveCellRef<X>::dynamicCast.
+        const void *mType;
+
         /** Information about this instance, such as 3D location and rotation
          * and individual type-dependent data.
          */
@@ -31,7 +35,7 @@ namespace MWWorld
         /** runtime-data */
         RefData mData;
 
-        LiveCellRefBase(const std::string& type, const ESM::CellRef &cref=ESM::CellRef());
+        LiveCellRefBase(const std::string& type, const void *typeTag, const ESM::CellRef &cref=ESM::CellRef());
         /* Need this for the class to be recognized as polymorphic */
         virtual ~LiveCellRefBase() { }
 
@@ -77,13 +81,32 @@ namespace MWWorld
     struct LiveCellRef : public LiveCellRefBase
     {
         LiveCellRef(const ESM::CellRef& cref, const X* b = NULL)
-            : LiveCellRefBase(typeid(X).name(), cref), mBase(b)
+            : LiveCellRefBase(typeid(X).name(), &sType, cref), mBase(b)
         {}
 
         LiveCellRef(const X* b = NULL)
-            : LiveCellRefBase(typeid(X).name()), mBase(b)
+            : LiveCellRefBase(typeid(X).name(), &sType), mBase(b)
         {}
 
+        /// Only the address of this is used, as the type tag of LiveCellRef<X>.
+        /// \note Deliberately not const, so that the linker can not fold the tags of different types into one.
+        static char sType;
+
+        /// Cast \a ref to LiveCellRef<X>, if it is one. Cheaper than a dynamic_cast, which is checked against in
+        /// debug builds.
+        /// \return NULL if \a ref is NULL or is not a LiveCellRef<X>
+        static LiveCellRef *dynamicCast (LiveCellRefBase *ref)
+        {
+            LiveCellRef *result = (ref && ref->mType == &sType) ? static_cast<LiveCellRef*>(ref) : NULL;
+            assert (result == dynamic_cast<LiveCellRef*>(ref));
+            return result;
+        }
+
+        static const LiveCellRef *dynamicCast (const LiveCellRefBase *ref)
+        {
+            return dynamicCast (const_cast<LiveCellRefBase*>(ref));
+        }
+
         // The object that this instance is based on.
         const X* mBase;
 
@@ -103,6 +126,9 @@ namespace MWWorld
         /// \note Does not check if the RefId exists.
     };
 
+    template <typename X>
+    char LiveCellRef<X>::sType = 0;
+
     template <typename X>
     void LiveCellRef<X>::load (const ESM::ObjectState& state)
     {
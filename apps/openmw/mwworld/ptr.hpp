@@ -47,7 +47,7 @@ namespace MWWorld
             template<typename T>
             MWWorld::LiveCellRef<T> *get() const
             {
-                MWWorld::LiveCellRef<T> *ref = dynamic_cast<MWWorld::LiveCellRef<T>*>(mRef);
+                MWWorld::LiveCellRef<T> *ref = MWWorld::LiveCellRef<T>::dynamicCast(mRef);
                 if(ref) return ref;
 
                 std::stringstream str;
@@ -123,7 +123,7 @@ namespace MWWorld
         template<typename T>
         const MWWorld::LiveCellRef<T> *get() const
         {
-            const MWWorld::LiveCellRef<T> *ref = dynamic_cast<const MWWorld::LiveCellRef<T>*>(mRef);
+            const MWWorld::LiveCellRef<T> *ref = MWWorld::LiveCellRef<T>::dynamicCast(mRef);
             if(ref) return ref;
 
             std::stringstream str;
@@ -7,6 +7,8 @@
 #include <set>
 #include <memory>
 
+#include <components/sceneutil/workqueue.hpp>
+
 namespace osg
 {
     class Vec3f;
@@ -80,7 +82,7 @@ namespace MWWorld
             void preloadExteriorGrid();
             void preloadFastTravelDestinations();
 
-            void preloadCell(MWWorld::CellStore* cell, bool preloadSurrounding=false);
+            void preloadCell(MWWorld::CellStore* cell, bool preloadSurrounding=false, SceneUtil::WorkQueue::Priority priority=SceneUtil::WorkQueue::Priority_Normal);
 
         public:
 
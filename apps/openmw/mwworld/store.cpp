@@ -6,6 +6,7 @@
 #include <components/loadinglistener/loadinglistener.hpp>
 #include <components/misc/rng.hpp>
 
+#include <memory>
 #include <stdexcept>
 #include <sstream>
 
@@ -29,6 +30,13 @@ namespace
         }
     };
 
+    template<typename T>
+    struct StagedRecordT : public MWWorld::StagedRecord
+    {
+        T mRecord;
+        bool mIsDeleted;
+    };
+
     struct Compare
     {
         bool operator()(const ESM::Land *x, const ESM::Land *y) {
@@ -115,6 +123,8 @@ namespace MWWorld
     Store<T>::Store(const Store<T>& orig)
         : mStatic(orig.mStatic)
     {
+        for (typename Static::iterator it = mStatic.begin(); it != mStatic.end(); ++it)
+            mStaticIndex.insert(&it->second);
     }
 
     template<typename T>
@@ -124,32 +134,26 @@ namespace MWWorld
         assert(mShared.size() >= mStatic.size());
         mShared.erase(mShared.begin() + mStatic.size(), mShared.end());
         mDynamic.clear();
+        mDynamicIndex.clear();
     }
 
     template<typename T>
     const T *Store<T>::search(const std::string &id) const
     {
-        T item;
-        item.mId = Misc::StringUtils::lowerCase(id);
-
-        typename Dynamic::const_iterator dit = mDynamic.find(item.mId);
-        if (dit != mDynamic.end()) {
-            return &dit->second;
-        }
-
-        typename std::map<std::string, T>::const_iterator it = mStatic.find(item.mId);
-
-        if (it != mStatic.end() && Misc::StringUtils::ciEqual(it->second.mId, id)) {
-            return &(it->second);
-        }
+        return search(id.c_str(), id.size());
+    }
+    template<typename T>
+    const T *Store<T>::search(const char *id, size_t length) const
+    {
+        if (const T *record = mDynamicIndex.search(id, length))
+            return record;
 
-        return 0;
+        return mStaticIndex.search(id, length);
     }
     template<typename T>
     bool Store<T>::isDynamic(const std::string &id) const
     {
-        typename Dynamic::const_iterator dit = mDynamic.find(id);
-        return (dit != mDynamic.end());
+        return mDynamicIndex.search(id.c_str(), id.size()) != NULL;
     }
     template<typename T>
     const T *Store<T>::searchRandom(const std::string &id) const
@@ -192,9 +196,34 @@ namespace MWWorld
         record.load(esm, isDeleted);
         Misc::StringUtils::lowerCaseInPlace(record.mId);
 
+        return loadRecord(record, isDeleted);
+    }
+    template<typename T>
+    StagedRecord *Store<T>::stage(ESM::ESMReader &esm) const
+    {
+        std::auto_ptr<StagedRecordT<T> > staged (new StagedRecordT<T>);
+        staged->mIsDeleted = false;
+
+        staged->mRecord.load(esm, staged->mIsDeleted);
+        Misc::StringUtils::lowerCaseInPlace(staged->mRecord.mId);
+
+        return staged.release();
+    }
+    template<typename T>
+    RecordId Store<T>::merge(StagedRecord &record)
+    {
+        StagedRecordT<T> &staged = static_cast<StagedRecordT<T>&>(record);
+        return loadRecord(staged.mRecord, staged.mIsDeleted);
+    }
+    template<typename T>
+    RecordId Store<T>::loadRecord(const T &record, bool isDeleted)
+    {
         std::pair<typename Static::iterator, bool> inserted = mStatic.insert(std::make_pair(record.mId, record));
         if (inserted.second)
+        {
             mShared.push_back(&inserted.first->second);
+            mStaticIndex.insert(&inserted.first->second);
+        }
         else
             inserted.first->second = record;
 
@@ -245,6 +274,7 @@ namespace MWWorld
         T *ptr = &result.first->second;
         if (result.second) {
             mShared.push_back(ptr);
+            mDynamicIndex.insert(ptr);
         } else {
             *ptr = item;
         }
@@ -259,6 +289,7 @@ namespace MWWorld
         T *ptr = &result.first->second;
         if (result.second) {
             mShared.push_back(ptr);
+            mStaticIndex.insert(ptr);
         } else {
             *ptr = item;
         }
@@ -284,6 +315,7 @@ namespace MWWorld
                 }
                 ++sharedIter;
             }
+            mStaticIndex.erase(&it->second);
             mStatic.erase(it);
         }
 
@@ -298,6 +330,7 @@ namespace MWWorld
         if (it == mDynamic.end()) {
             return false;
         }
+        mDynamicIndex.erase(&it->second);
         mDynamic.erase(it);
 
         // have to reinit the whole shared part
@@ -1040,6 +1073,13 @@ namespace MWWorld
         }
     }
 
+    template <>
+    StagedRecord *Store<ESM::Dialogue>::stage(ESM::ESMReader &esm) const
+    {
+        // Merged on a per-subrecord basis, and the following INFO records need to find it in the Store
+        return NULL;
+    }
+
     template <>
     inline RecordId Store<ESM::Dialogue>::load(ESM::ESMReader &esm) {
         // The original letter case of a dialogue ID is saved, because it's printed
@@ -1053,7 +1093,8 @@ namespace MWWorld
         if (found == mStatic.end())
         {
             dialogue.loadData(esm, isDeleted);
-            mStatic.insert(std::make_pair(idLower, dialogue));
+            std::pair<Static::iterator, bool> inserted = mStatic.insert(std::make_pair(idLower, dialogue));
+            mStaticIndex.insert(&inserted.first->second);
         }
         else
         {
@@ -6,6 +6,7 @@
 #include <map>
 
 #include "recordcmp.hpp"
+#include "storeindex.hpp"
 
 namespace ESM
 {
@@ -27,6 +28,12 @@ namespace MWWorld
         RecordId(const std::string &id = "", bool isDeleted = false);
     };
 
+    /// @brief A record that was decoded by StoreBase::stage(), waiting to be merged into its Store.
+    struct StagedRecord
+    {
+        virtual ~StagedRecord() {}
+    };
+
     class StoreBase
     {
     public:
@@ -41,6 +48,13 @@ namespace MWWorld
         virtual int getDynamicSize() const { return 0; }
         virtual RecordId load(ESM::ESMReader &esm) = 0;
 
+        /// Decode the current record without modifying the Store, so that this may be done in a background thread.
+        /// @return The decoded record, or NULL without reading anything if the record has to go through load(), in load order.
+        virtual StagedRecord *stage(ESM::ESMReader &esm) const { return NULL; }
+
+        /// Merge a record returned by stage(). Equivalent to load() of the same record.
+        virtual RecordId merge(StagedRecord &record) { return RecordId(); }
+
         virtual bool eraseStatic(const std::string &id) {return false;}
         virtual void clearDynamic() {}
 
@@ -147,8 +161,17 @@ namespace MWWorld
         typedef std::map<std::string, T> Dynamic;
         typedef std::map<std::string, T> Static;
 
+        // Hash lookup for the records in mStatic and mDynamic
+        StoreIndex<T> mStaticIndex;
+        StoreIndex<T> mDynamicIndex;
+
         friend class ESMStore;
 
+        RecordId loadRecord(const T &record, bool isDeleted);
+
+        /// Not implemented, the copied indexes would point into the records of \a orig.
+        Store<T> &operator=(const Store<T> &orig);
+
     public:
         Store();
         Store(const Store<T> &orig);
@@ -161,6 +184,10 @@ namespace MWWorld
 
         const T *search(const std::string &id) const;
 
+        /// Same as search(const std::string&), for IDs that are not held in a std::string.
+        /// @note Case-insensitive, doesn't allocate.
+        const T *search(const char *id, size_t length) const;
+
         /**
          * Does the record with this ID come from the dynamic store?
          */
@@ -192,6 +219,8 @@ namespace MWWorld
         bool erase(const T &item);
 
         RecordId load(ESM::ESMReader &esm);
+        StagedRecord *stage(ESM::ESMReader &esm) const;
+        RecordId merge(StagedRecord &record);
         void write(ESM::ESMWriter& writer, Loading::Listener& progress) const;
         RecordId read(ESM::ESMReader& reader);
     };
@@ -0,0 +1,159 @@
+#ifndef OPENMW_MWWORLD_STOREINDEX_H
+#define OPENMW_MWWORLD_STOREINDEX_H
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include <components/misc/stringops.hpp>
+
+namespace MWWorld
+{
+    /// @brief Case-insensitive hash index over records that are owned by a Store, keyed by the record's mId.
+    /// Lookups don't allocate and don't need a lower-cased copy of the ID.
+    /// @note The index does not own the records. An indexed record must stay at the same address and keep
+    /// its ID (up to letter case) until it is erased from the index.
+    template <class T>
+    class StoreIndex
+    {
+    public:
+        StoreIndex()
+            : mSize(0)
+        {
+        }
+
+        /// FNV-1a over the lower-cased ID.
+        static uint32_t hash(const char* id, size_t length)
+        {
+            uint32_t result = 2166136261u;
+            for (size_t i=0; i<length; ++i)
+            {
+                result ^= static_cast<unsigned char>(Misc::StringUtils::toLower(id[i]));
+                result *= 16777619u;
+            }
+            return result;
+        }
+
+        T* search(const char* id, size_t length) const
+        {
+            if (mSlots.empty())
+                return NULL;
+
+            const uint32_t idHash = hash(id, length);
+            const size_t mask = mSlots.size() - 1;
+            for (size_t i = idHash & mask; mSlots[i].mRecord; i = (i + 1) & mask)
+            {
+                if (mSlots[i].mHash == idHash && equals(mSlots[i].mRecord->mId, id, length))
+                    return mSlots[i].mRecord;
+            }
+            return NULL;
+        }
+
+        /// @note The record must not be indexed already.
+        void insert(T* record)
+        {
+            if ((mSize + 1) * 2 > mSlots.size())
+                rehash(mSlots.empty() ? 64 : mSlots.size() * 2);
+
+            Slot slot;
+            slot.mHash = hash(record->mId.c_str(), record->mId.size());
+            slot.mRecord = record;
+            place(slot);
+            ++mSize;
+        }
+
+        /// @return Was the record indexed?
+        bool erase(const T* record)
+        {
+            if (mSlots.empty())
+                return false;
+
+            const size_t mask = mSlots.size() - 1;
+            size_t i = hash(record->mId.c_str(), record->mId.size()) & mask;
+            while (mSlots[i].mRecord != record)
+            {
+                if (!mSlots[i].mRecord)
+                    return false;
+                i = (i + 1) & mask;
+            }
+
+            // backward shift deletion, so that we don't need tombstones
+            mSlots[i].mRecord = NULL;
+            for (size_t j = (i + 1) & mask; mSlots[j].mRecord; j = (j + 1) & mask)
+            {
+                size_t home = mSlots[j].mHash & mask;
+                bool reachable = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+                if (!reachable)
+                {
+                    mSlots[i] = mSlots[j];
+                    mSlots[j].mRecord = NULL;
+                    i = j;
+                }
+            }
+            --mSize;
+            return true;
+        }
+
+        void clear()
+        {
+            mSlots.clear();
+            mSize = 0;
+        }
+
+        size_t size() const
+        {
+            return mSize;
+        }
+
+    private:
+        struct Slot
+        {
+            uint32_t mHash;
+            T* mRecord; // NULL for an empty slot
+        };
+
+        static bool equals(const std::string& recordId, const char* id, size_t length)
+        {
+            if (recordId.size() != length)
+                return false;
+            for (size_t i=0; i<length; ++i)
+            {
+                if (Misc::StringUtils::toLower(recordId[i]) != Misc::StringUtils::toLower(id[i]))
+                    return false;
+            }
+            return true;
+        }
+
+        void place(const Slot& slot)
+        {
+            const size_t mask = mSlots.size() - 1;
+            size_t i = slot.mHash & mask;
+            while (mSlots[i].mRecord)
+                i = (i + 1) & mask;
+            mSlots[i] = slot;
+        }
+
+        void rehash(size_t size)
+        {
+            std::vector<Slot> old;
+            old.swap(mSlots);
+
+            Slot empty;
+            empty.mHash = 0;
+            empty.mRecord = NULL;
+            mSlots.resize(size, empty);
+
+            for (typename std::vector<Slot>::const_iterator it = old.begin(); it != old.end(); ++it)
+            {
+                if (it->mRecord)
+                    place(*it);
+            }
+        }
+
+        std::vector<Slot> mSlots; // power of two size, at most half full
+        size_t mSize;
+    };
+}
+
+#endif
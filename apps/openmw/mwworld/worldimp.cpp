@@ -92,6 +92,13 @@ namespace MWWorld
             return mLoaders.insert(std::make_pair(extension, loader)).second;
         }
 
+        void prepare(const boost::filesystem::path& filepath, int index)
+        {
+            LoadersContainer::iterator it(mLoaders.find(Misc::StringUtils::lowerCase(filepath.extension().string())));
+            if (it != mLoaders.end())
+                it->second->prepare(filepath, index);
+        }
+
         void load(const boost::filesystem::path& filepath, int& index)
         {
             LoadersContainer::iterator it(mLoaders.find(Misc::StringUtils::lowerCase(filepath.extension().string())));
@@ -174,7 +181,7 @@ namespace MWWorld
         listener->loadingOn();
 
         GameContentLoader gameContentLoader(*listener);
-        EsmLoader esmLoader(mStore, mEsm, encoder, *listener);
+        EsmLoader esmLoader(mStore, mEsm, encoder, *listener, Settings::Manager::getInt("content loading threads", "General"));
 
         gameContentLoader.addLoader(".esm", &esmLoader);
         gameContentLoader.addLoader(".esp", &esmLoader);
@@ -1598,6 +1605,9 @@ namespace MWWorld
         updateSoundListener();
 
         updatePlayer(paused);
+
+        // run the movement prepared in doPhysics while this frame is rendered
+        mPhysics->startPendingStep();
     }
 
     void World::updatePlayer(bool paused)
@@ -2526,15 +2536,16 @@ namespace MWWorld
     void World::loadContentFiles(const Files::Collections& fileCollections,
         const std::vector<std::string>& content, ContentLoader& contentLoader)
     {
+        std::vector<boost::filesystem::path> paths;
         std::vector<std::string>::const_iterator it(content.begin());
         std::vector<std::string>::const_iterator end(content.end());
-        for (int idx = 0; it != end; ++it, ++idx)
+        for (; it != end; ++it)
         {
             boost::filesystem::path filename(*it);
             const Files::MultiDirCollection& col = fileCollections.getCollection(filename.extension().string());
             if (col.doesExist(*it))
             {
-                contentLoader.load(col.getPath(*it), idx);
+                paths.push_back(col.getPath(*it));
             }
             else
             {
@@ -2543,6 +2554,12 @@ namespace MWWorld
                 throw std::runtime_error(msg.str());
             }
         }
+
+        for (int idx = 0; idx < static_cast<int>(paths.size()); ++idx)
+            contentLoader.prepare(paths[idx], idx);
+
+        for (int idx = 0; idx < static_cast<int>(paths.size()); ++idx)
+            contentLoader.load(paths[idx], idx);
     }
 
     bool World::startSpellCast(const Ptr &actor)
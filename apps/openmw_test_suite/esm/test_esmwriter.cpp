@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include <components/esm/esmreader.hpp>
+#include <components/esm/esmwriter.hpp>
+
+namespace
+{
+    const std::string sLongString (1000, 'x');
+
+    std::string writeFile(bool compressed)
+    {
+        std::stringstream stream;
+        ESM::ESMWriter writer;
+        writer.setFormat(3);
+        writer.setRecordCount(5);
+        writer.save(stream);
+
+        writer.startRecord("FRST");
+        writer.writeHNString("NAME", "uncompressed");
+        writer.endRecord("FRST");
+
+        writer.setCompressed(compressed);
+
+        for (int i=0; i<3; ++i)
+        {
+            writer.startRecord("SCND", 0x0400);
+            writer.writeHNString("NAME", sLongString);
+            writer.writeHNT("INDX", i);
+            writer.endRecord("SCND");
+        }
+
+        writer.setCompressed(false);
+
+        writer.startRecord("THRD");
+        writer.writeHNT("DATA", 42.f);
+        writer.endRecord("THRD");
+
+        writer.close();
+        return stream.str();
+    }
+
+    void expectRecord(ESM::ESMReader& reader, const char* name)
+    {
+        ASSERT_TRUE(reader.hasMoreRecs());
+        EXPECT_EQ(std::string(name), reader.getRecName().toString());
+        reader.getRecHeader();
+    }
+
+    void readFile(const std::string& data, bool compressed, bool skip)
+    {
+        ESM::ESMReader reader;
+        reader.setEncoder(NULL);
+        reader.open(Files::IStreamPtr(new std::istringstream(data)), "test");
+        EXPECT_EQ(3, reader.getFormat());
+
+        expectRecord(reader, "FRST");
+        EXPECT_EQ(0u, reader.getRecordFlags() & ESM::FLAG_Compressed);
+        EXPECT_EQ("uncompressed", reader.getHNString("NAME"));
+        EXPECT_FALSE(reader.hasMoreSubs());
+
+        for (int i=0; i<3; ++i)
+        {
+            expectRecord(reader, "SCND");
+            EXPECT_EQ(compressed ? ESM::FLAG_Compressed : 0u, reader.getRecordFlags() & ESM::FLAG_Compressed);
+            EXPECT_EQ(0x0400u, reader.getRecordFlags() & 0x0400);
+            if (skip)
+            {
+                reader.skipRecord();
+                continue;
+            }
+            EXPECT_EQ(sLongString, reader.getHNString("NAME"));
+            int index = -1;
+            reader.getHNT(index, "INDX");
+            EXPECT_EQ(i, index);
+            EXPECT_FALSE(reader.hasMoreSubs());
+        }
+
+        expectRecord(reader, "THRD");
+        EXPECT_EQ(0u, reader.getRecordFlags() & ESM::FLAG_Compressed);
+        float value = 0.f;
+        reader.getHNT(value, "DATA");
+        EXPECT_EQ(42.f, value);
+        EXPECT_FALSE(reader.hasMoreRecs());
+    }
+}
+
+TEST(ESMWriterTest, uncompressed_records_round_trip)
+{
+    std::string data = writeFile(false);
+    readFile(data, false, false);
+    readFile(data, false, true);
+}
+
+TEST(ESMWriterTest, compressed_records_round_trip)
+{
+    std::string data = writeFile(true);
+    EXPECT_LT(data.size(), writeFile(false).size());
+    readFile(data, true, false);
+    readFile(data, true, true);
+}
@@ -0,0 +1,422 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+
+#include <components/esm/defs.hpp>
+#include <components/esm/esmreader.hpp>
+#include <components/esm/esmwriter.hpp>
+#include <components/esm/loadland.hpp>
+#include <components/esm/loadpgrd.hpp>
+
+#include "apps/openmw/mwmechanics/cellgraph.hpp"
+#include "apps/openmw/mwmechanics/pathgrid.hpp"
+#include "apps/openmw/mwworld/store.hpp"
+
+namespace
+{
+    void addEdge(ESM::Pathgrid& grid, int v0, int v1)
+    {
+        ESM::Pathgrid::Edge edge;
+        edge.mV0 = v0;
+        edge.mV1 = v1;
+        grid.mEdges.push_back(edge);
+        // like in the ESM files, both directions are listed
+        edge.mV0 = v1;
+        edge.mV1 = v0;
+        grid.mEdges.push_back(edge);
+    }
+
+    /// A square grid of points, connected to their horizontal and vertical neighbours.
+    ESM::Pathgrid makeGrid(int size, int spacing)
+    {
+        ESM::Pathgrid grid;
+        for (int y=0; y<size; ++y)
+            for (int x=0; x<size; ++x)
+                grid.mPoints.push_back(ESM::Pathgrid::Point(x * spacing, y * spacing, 0));
+
+        for (int y=0; y<size; ++y)
+        {
+            for (int x=0; x<size; ++x)
+            {
+                if (x+1 < size)
+                    addEdge(grid, y*size + x, y*size + x+1);
+                if (y+1 < size)
+                    addEdge(grid, y*size + x, (y+1)*size + x);
+            }
+        }
+        return grid;
+    }
+
+    bool isConnected(const ESM::Pathgrid& grid, int v0, int v1)
+    {
+        for (ESM::Pathgrid::EdgeList::const_iterator it = grid.mEdges.begin(); it != grid.mEdges.end(); ++it)
+        {
+            if (it->mV0 == v0 && it->mV1 == v1)
+                return true;
+        }
+        return false;
+    }
+
+    /// A row of points across an exterior cell from west to east, at the given y, each connected to the next.
+    /// @return Index of the first point
+    int addRoad(ESM::Pathgrid& grid, int y)
+    {
+        const int first = static_cast<int>(grid.mPoints.size());
+        grid.mPoints.push_back(ESM::Pathgrid::Point(512, y, 0));
+        grid.mPoints.push_back(ESM::Pathgrid::Point(ESM::Land::REAL_SIZE / 2, y, 0));
+        grid.mPoints.push_back(ESM::Pathgrid::Point(ESM::Land::REAL_SIZE - 512, y, 0));
+        addEdge(grid, first, first+1);
+        addEdge(grid, first+1, first+2);
+        return first;
+    }
+
+    /// Write the exterior pathgrids to an in-memory content file and load them into the store,
+    /// since Store<ESM::Pathgrid> can only be filled from a reader.
+    void loadPathgrids(std::vector<ESM::Pathgrid> grids, MWWorld::Store<ESM::Pathgrid>& store)
+    {
+        ESM::ESMWriter writer;
+        std::stringstream* stream = new std::stringstream;
+        writer.setFormat(0);
+        writer.save(*stream);
+        for (std::vector<ESM::Pathgrid>::iterator grid = grids.begin(); grid != grids.end(); ++grid)
+        {
+            // the edges are stored as the connections of each point, in the order of the points
+            std::vector<ESM::Pathgrid::Edge> edges;
+            for (size_t point=0; point<grid->mPoints.size(); ++point)
+            {
+                grid->mPoints[point].mConnectionNum = 0;
+                for (ESM::Pathgrid::EdgeList::const_iterator edge = grid->mEdges.begin(); edge != grid->mEdges.end(); ++edge)
+                {
+                    if (edge->mV0 != static_cast<int>(point))
+                        continue;
+                    edges.push_back(*edge);
+                    ++grid->mPoints[point].mConnectionNum;
+                }
+            }
+            grid->mEdges.swap(edges);
+            grid->mData.mS1 = 0;
+            grid->mData.mS2 = static_cast<short>(grid->mPoints.size());
+
+            writer.startRecord(ESM::Pathgrid::sRecordId);
+            grid->save(writer, false);
+            writer.endRecord(ESM::Pathgrid::sRecordId);
+        }
+
+        ESM::ESMReader reader;
+        reader.setEncoder(NULL);
+        reader.open(Files::IStreamPtr(stream), "pathgrids");
+        while (reader.hasMoreRecs())
+        {
+            reader.getRecName();
+            reader.getRecHeader();
+            store.load(reader);
+        }
+    }
+
+    ESM::Pathgrid makeExteriorGrid(int x, int y)
+    {
+        ESM::Pathgrid grid;
+        grid.mData.mX = x;
+        grid.mData.mY = y;
+        grid.mCell = "Wilderness";
+        return grid;
+    }
+
+    void expectValidPath(const ESM::Pathgrid& grid, const MWMechanics::PathgridPath& path, int start, int goal)
+    {
+        ASSERT_FALSE(path.empty());
+        EXPECT_EQ(start, path.front());
+        EXPECT_EQ(goal, path.back());
+        for (size_t i=1; i<path.size(); ++i)
+            EXPECT_TRUE(isConnected(grid, path[i-1], path[i])) << path[i-1] << " -> " << path[i];
+    }
+}
+
+TEST(PathgridGraphTest, finds_path_across_grid)
+{
+    ESM::Pathgrid grid = makeGrid(8, 100);
+    MWMechanics::PathgridGraph graph;
+    ASSERT_TRUE(graph.load(&grid));
+
+    MWMechanics::AStarScratch scratch;
+    MWMechanics::PathgridPath path;
+    ASSERT_TRUE(graph.aStarSearch(0, 63, path, scratch));
+    expectValidPath(grid, path, 0, 63);
+    // the heuristic makes the search greedy, but on a plain grid it still finds a shortest path
+    EXPECT_EQ(15u, path.size());
+
+    ASSERT_TRUE(graph.aStarSearch(63, 7, path, scratch));
+    expectValidPath(grid, path, 63, 7);
+    EXPECT_EQ(8u, path.size());
+}
+
+TEST(PathgridGraphTest, path_to_start_is_start)
+{
+    ESM::Pathgrid grid = makeGrid(3, 100);
+    MWMechanics::PathgridGraph graph;
+    ASSERT_TRUE(graph.load(&grid));
+
+    MWMechanics::AStarScratch scratch;
+    MWMechanics::PathgridPath path;
+    ASSERT_TRUE(graph.aStarSearch(4, 4, path, scratch));
+    ASSERT_EQ(1u, path.size());
+    EXPECT_EQ(4, path.front());
+}
+
+TEST(PathgridGraphTest, no_path_between_components)
+{
+    ESM::Pathgrid grid;
+    for (int i=0; i<4; ++i)
+        grid.mPoints.push_back(ESM::Pathgrid::Point(i * 100, 0, 0));
+    addEdge(grid, 0, 1);
+    addEdge(grid, 2, 3);
+
+    MWMechanics::PathgridGraph graph;
+    ASSERT_TRUE(graph.load(&grid));
+    EXPECT_FALSE(graph.isPointConnected(0, 3));
+
+    MWMechanics::AStarScratch scratch;
+    MWMechanics::PathgridPath path;
+    path.push_back(42);
+    EXPECT_FALSE(graph.aStarSearch(0, 3, path, scratch));
+    EXPECT_TRUE(path.empty());
+
+    ASSERT_TRUE(graph.aStarSearch(3, 2, path, scratch));
+    expectValidPath(grid, path, 3, 2);
+}
+
+TEST(PathgridGraphTest, scratch_reused_across_graphs)
+{
+    ESM::Pathgrid small = makeGrid(2, 100);
+    ESM::Pathgrid large = makeGrid(10, 50);
+    MWMechanics::PathgridGraph smallGraph;
+    MWMechanics::PathgridGraph largeGraph;
+    ASSERT_TRUE(smallGraph.load(&small));
+    ASSERT_TRUE(largeGraph.load(&large));
+
+    MWMechanics::AStarScratch scratch;
+    MWMechanics::PathgridPath path;
+    for (int i=0; i<3; ++i)
+    {
+        ASSERT_TRUE(smallGraph.aStarSearch(0, 3, path, scratch));
+        expectValidPath(small, path, 0, 3);
+        ASSERT_TRUE(largeGraph.aStarSearch(99, i, path, scratch));
+        expectValidPath(large, path, 99, i);
+    }
+}
+
+TEST(PathgridGraphTest, cached_paths_reused_for_same_goal)
+{
+    MWMechanics::PathgridPathCache cache;
+    MWMechanics::PathgridPath cached;
+    cached.push_back(5);
+    cached.push_back(3);
+    cached.push_back(8);
+    cached.push_back(2);
+    cache.insert(2, cached);
+
+    MWMechanics::PathgridPath path;
+    ASSERT_TRUE(cache.find(5, 2, path));
+    EXPECT_EQ(cached, path);
+
+    // starting further along the cached path
+    ASSERT_TRUE(cache.find(8, 2, path));
+    ASSERT_EQ(2u, path.size());
+    EXPECT_EQ(8, path[0]);
+    EXPECT_EQ(2, path[1]);
+
+    EXPECT_FALSE(cache.find(5, 8, path));
+    EXPECT_FALSE(cache.find(7, 2, path));
+
+    cache.clear();
+    EXPECT_FALSE(cache.find(5, 2, path));
+}
+
+TEST(PathgridGraphTest, find_path_matches_search)
+{
+    ESM::Pathgrid grid = makeGrid(6, 100);
+    MWMechanics::PathgridGraph graph;
+    ASSERT_TRUE(graph.load(&grid));
+
+    MWMechanics::AStarScratch scratch;
+    MWMechanics::PathgridPath searched;
+    MWMechanics::PathgridPath found;
+    for (int start=0; start<36; ++start)
+    {
+        ASSERT_TRUE(graph.findPath(start, 35, found, scratch));
+        expectValidPath(grid, found, start, 35);
+        ASSERT_TRUE(graph.aStarSearch(start, 35, searched, scratch));
+        EXPECT_EQ(searched.size(), found.size());
+    }
+}
+
+class CellGraphTest : public testing::Test
+{
+protected:
+    CellGraphTest()
+    {
+        // no interior cells, so all pathgrids are taken as exterior ones
+        mPathgrids.setCells(mCells);
+    }
+
+    MWWorld::Store<ESM::Cell> mCells;
+    MWWorld::Store<ESM::Pathgrid> mPathgrids;
+};
+
+TEST_F(CellGraphTest, finds_route_along_cells)
+{
+    std::vector<ESM::Pathgrid> grids;
+    for (int x=0; x<4; ++x)
+    {
+        grids.push_back(makeExteriorGrid(x, 0));
+        addRoad(grids.back(), ESM::Land::REAL_SIZE / 2);
+    }
+    loadPathgrids(grids, mPathgrids);
+
+    MWMechanics::CellGraph graph (mPathgrids);
+    std::vector<MWMechanics::CellGraph::Portal> route;
+    ASSERT_TRUE(graph.findRoute(0, 0, 0, 3, 0, 2, route));
+    ASSERT_EQ(3u, route.size());
+    for (int i=0; i<3; ++i)
+    {
+        EXPECT_EQ(i+1, route[i].mCellX);
+        EXPECT_EQ(0, route[i].mCellY);
+        // from the east end of the road in one cell to the west end in the next
+        EXPECT_EQ(2, route[i].mFromIndex);
+        EXPECT_EQ(0, route[i].mToIndex);
+        EXPECT_EQ((i+1) * ESM::Land::REAL_SIZE - 512, route[i].mFrom.mX);
+        EXPECT_EQ((i+1) * ESM::Land::REAL_SIZE + 512, route[i].mTo.mX);
+    }
+
+    // no need to leave the cell
+    ASSERT_TRUE(graph.findRoute(2, 0, 0, 2, 0, 2, route));
+    EXPECT_TRUE(route.empty());
+
+    // no pathgrid to go through
+    EXPECT_FALSE(graph.findRoute(0, 0, 0, 0, 1, -1, route));
+}
+
+TEST_F(CellGraphTest, route_only_crosses_connected_portals)
+{
+    // Two roads run from cell 0 to cell 2, unconnected until they meet in cell 2.
+    // The north road is broken in cell 1, so only the south road gets through.
+    const int north = ESM::Land::REAL_SIZE * 3 / 4;
+    const int south = ESM::Land::REAL_SIZE / 4;
+
+    std::vector<ESM::Pathgrid> grids;
+    grids.push_back(makeExteriorGrid(0, 0));
+    const int northStart = addRoad(grids.back(), north);
+    const int southStart = addRoad(grids.back(), south);
+
+    grids.push_back(makeExteriorGrid(1, 0));
+    grids.back().mPoints.push_back(ESM::Pathgrid::Point(512, north, 0));
+    grids.back().mPoints.push_back(ESM::Pathgrid::Point(ESM::Land::REAL_SIZE / 2, north, 0));
+    grids.back().mPoints.push_back(ESM::Pathgrid::Point(ESM::Land::REAL_SIZE - 512, north, 0));
+    addEdge(grids.back(), 0, 1);
+    addRoad(grids.back(), south);
+
+    grids.push_back(makeExteriorGrid(2, 0));
+    const int northGoal = addRoad(grids.back(), north) + 2;
+    addRoad(grids.back(), south);
+    addEdge(grids.back(), 1, 4);
+
+    loadPathgrids(grids, mPathgrids);
+
+    MWMechanics::CellGraph graph (mPathgrids);
+    std::vector<MWMechanics::CellGraph::Portal> route;
+    EXPECT_FALSE(graph.findRoute(0, 0, northStart, 2, 0, northGoal, route));
+
+    ASSERT_TRUE(graph.findRoute(0, 0, southStart, 2, 0, northGoal, route));
+    ASSERT_EQ(2u, route.size());
+    EXPECT_EQ(southStart + 2, route[0].mFromIndex);
+    EXPECT_EQ(south, route[0].mFrom.mY);
+    EXPECT_EQ(1, route[0].mCellX);
+    EXPECT_EQ(2, route[1].mCellX);
+    EXPECT_EQ(south, route[1].mTo.mY);
+}
+
+/// Searches paths between pairs of points of every pathgrid in the content files listed (separated by ';') in the
+/// OPENMW_CONTENT_FILES environment variable, e.g. the full paths of Morrowind.esm, Tribunal.esm and Bloodmoon.esm.
+TEST(PathgridGraphTest, DISABLED_benchmark_content_pathgrids)
+{
+    const char* contentFiles = std::getenv("OPENMW_CONTENT_FILES");
+    if (!contentFiles)
+    {
+        std::cout << "OPENMW_CONTENT_FILES is not set, skipping" << std::endl;
+        return;
+    }
+
+    std::vector<ESM::Pathgrid> pathgrids;
+    std::stringstream stream (contentFiles);
+    std::string file;
+    while (std::getline(stream, file, ';'))
+    {
+        if (file.empty())
+            continue;
+
+        ESM::ESMReader reader;
+        reader.setEncoder(NULL);
+        reader.open(file);
+        while (reader.hasMoreRecs())
+        {
+            ESM::NAME name = reader.getRecName();
+            reader.getRecHeader();
+            if (name.val != ESM::REC_PGRD)
+            {
+                reader.skipRecord();
+                continue;
+            }
+
+            ESM::Pathgrid pathgrid;
+            bool isDeleted = false;
+            pathgrid.load(reader, isDeleted);
+            if (!isDeleted && !pathgrid.mPoints.empty())
+                pathgrids.push_back(pathgrid);
+        }
+    }
+
+    if (pathgrids.empty())
+    {
+        std::cout << "No pathgrids found" << std::endl;
+        return;
+    }
+
+    // every pair of points for small pathgrids, a sample of pairs for large ones
+    const size_t maxQueriesPerGrid = 4096;
+    std::srand(0);
+
+    MWMechanics::AStarScratch scratch;
+    MWMechanics::PathgridPath path;
+    size_t queries = 0;
+    size_t found = 0;
+    size_t points = 0;
+    std::clock_t duration = 0;
+    for (std::vector<ESM::Pathgrid>::const_iterator grid = pathgrids.begin(); grid != pathgrids.end(); ++grid)
+    {
+        MWMechanics::PathgridGraph graph;
+        if (!graph.load(&*grid))
+            continue;
+
+        const size_t size = grid->mPoints.size();
+        points += size;
+        const bool allPairs = size * size <= maxQueriesPerGrid;
+        const size_t gridQueries = allPairs ? size * size : maxQueriesPerGrid;
+
+        std::clock_t start = std::clock();
+        for (size_t i=0; i<gridQueries; ++i)
+        {
+            int from = static_cast<int>(allPairs ? i / size : std::rand() % size);
+            int to = static_cast<int>(allPairs ? i % size : std::rand() % size);
+            if (graph.aStarSearch(from, to, path, scratch))
+                ++found;
+        }
+        duration += std::clock() - start;
+        queries += gridQueries;
+    }
+
+    std::cout << pathgrids.size() << " pathgrids, " << points << " points, " << queries << " queries ("
+              << found << " with a path): " << duration * 1000.0 / CLOCKS_PER_SEC << " ms" << std::endl;
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "apps/openmw/mwworld/chunkedvector.hpp"
+
+namespace
+{
+    typedef MWWorld::ChunkedVector<std::string> Strings;
+
+    std::string toString(int i)
+    {
+        return std::string(static_cast<size_t>(i % 7) + 1, static_cast<char>('a' + i % 26));
+    }
+}
+
+TEST(ChunkedVectorTest, empty)
+{
+    Strings strings;
+    EXPECT_TRUE(strings.empty());
+    EXPECT_EQ(0u, strings.size());
+    EXPECT_TRUE(strings.begin() == strings.end());
+
+    const Strings& constStrings = strings;
+    EXPECT_TRUE(constStrings.begin() == constStrings.end());
+}
+
+TEST(ChunkedVectorTest, iterates_in_insertion_order)
+{
+    Strings strings;
+    for (int i=0; i<1000; ++i)
+    {
+        strings.push_back(toString(i));
+        EXPECT_EQ(toString(i), strings.back());
+    }
+    EXPECT_EQ(1000u, strings.size());
+    EXPECT_EQ(toString(0), strings.front());
+
+    int i = 0;
+    for (Strings::const_iterator it = strings.begin(); it != strings.end(); ++it, ++i)
+        EXPECT_EQ(toString(i), *it);
+    EXPECT_EQ(1000, i);
+
+    for (Strings::iterator it = strings.end(); it != strings.begin();)
+    {
+        --it;
+        --i;
+        EXPECT_EQ(toString(i), *it);
+    }
+    EXPECT_EQ(0, i);
+
+    EXPECT_TRUE(std::find(strings.begin(), strings.end(), toString(500)) != strings.end());
+    EXPECT_TRUE(std::find(strings.begin(), strings.end(), "missing") == strings.end());
+}
+
+TEST(ChunkedVectorTest, elements_keep_their_address)
+{
+    Strings strings;
+    std::vector<std::string*> pointers;
+    std::vector<Strings::iterator> iterators;
+    for (int i=0; i<600; ++i)
+    {
+        strings.push_back(toString(i));
+        pointers.push_back(&strings.back());
+        iterators.push_back(--strings.end());
+    }
+
+    for (int i=0; i<600; ++i)
+    {
+        EXPECT_EQ(toString(i), *pointers[i]);
+        EXPECT_EQ(pointers[i], &*iterators[i]);
+    }
+}
+
+TEST(ChunkedVectorTest, copies_are_independent)
+{
+    Strings strings;
+    for (int i=0; i<10; ++i)
+        strings.push_back(toString(i));
+
+    Strings copy (strings);
+    copy.push_back("copy");
+    *copy.begin() = "changed";
+    EXPECT_EQ(10u, strings.size());
+    EXPECT_EQ(11u, copy.size());
+    EXPECT_EQ(toString(0), strings.front());
+
+    strings = copy;
+    EXPECT_EQ(11u, strings.size());
+    EXPECT_EQ("changed", strings.front());
+    EXPECT_EQ("copy", strings.back());
+
+    strings.clear();
+    EXPECT_TRUE(strings.empty());
+    EXPECT_EQ(11u, copy.size());
+}
@@ -313,3 +313,57 @@ TEST_F(StoreTest, overwrite_test)
 
     ASSERT_TRUE (overwrittenRec && overwrittenRec->mModel == "the_new_model");
 }
+
+/// Tests case-insensitive lookup of static and dynamic records through the hash index.
+TEST_F(StoreTest, search_test)
+{
+    typedef ESM::Apparatus RecordType;
+
+    MWWorld::Store<RecordType> store;
+
+    const int count = 1000;
+    for (int i=0; i<count; ++i)
+    {
+        RecordType record;
+        record.blank();
+        std::ostringstream id;
+        id << "Static_" << i;
+        record.mId = id.str();
+        store.insertStatic(record);
+
+        std::ostringstream dynamicId;
+        dynamicId << "$dynamic" << i;
+        record.mId = dynamicId.str();
+        store.insert(record);
+    }
+
+    for (int i=0; i<count; i+=2)
+    {
+        std::ostringstream id;
+        id << "static_" << i;
+        store.eraseStatic(id.str());
+
+        std::ostringstream dynamicId;
+        dynamicId << "$Dynamic" << i;
+        store.erase(dynamicId.str());
+    }
+
+    for (int i=0; i<count; ++i)
+    {
+        std::ostringstream id;
+        id << "STATIC_" << i;
+        const RecordType* record = store.search(id.str());
+        ASSERT_EQ(i % 2 != 0, record != NULL);
+        if (record)
+            ASSERT_TRUE(Misc::StringUtils::ciEqual(id.str(), record->mId));
+
+        std::ostringstream dynamicId;
+        dynamicId << "$DYNAMIC" << i;
+        ASSERT_EQ(i % 2 != 0, store.search(dynamicId.str().c_str(), dynamicId.str().size()) != NULL);
+        ASSERT_EQ(i % 2 != 0, store.isDynamic(dynamicId.str()));
+    }
+
+    store.clearDynamic();
+    ASSERT_TRUE(store.search("$dynamic1") == NULL);
+    ASSERT_TRUE(store.search("static_1") != NULL);
+}
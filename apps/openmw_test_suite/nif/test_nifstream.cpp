@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <components/misc/stringops.hpp>
+#include <components/nif/nifstream.hpp>
+#include <components/nif/niffile.hpp>
+#include <components/nif/nifkey.hpp>
+
+namespace
+{
+    void writeLE32(std::ostream& stream, uint32_t value)
+    {
+        for (int i=0; i<4; ++i)
+            stream.put(static_cast<char>((value >> (i*8)) & 0xff));
+    }
+
+    void writeFloat(std::ostream& stream, float value)
+    {
+        union {
+            float f;
+            uint32_t i;
+        } u;
+        u.f = value;
+        writeLE32(stream, u.i);
+    }
+
+    Files::IStreamPtr makeStream(const std::string& data)
+    {
+        return Files::IStreamPtr(new std::istringstream(data));
+    }
+}
+
+/// Keys out of order are sorted, and of several keys with the same time the last one wins.
+TEST(NIFStreamTest, keys_sorted_by_time)
+{
+    std::ostringstream data;
+    writeLE32(data, 4); // count
+    writeLE32(data, Nif::FloatKeyMap::sLinearInterpolation);
+    writeFloat(data, 1.f); writeFloat(data, 10.f);
+    writeFloat(data, 0.5f); writeFloat(data, 20.f);
+    writeFloat(data, 1.f); writeFloat(data, 30.f);
+    writeFloat(data, 2.f); writeFloat(data, 40.f);
+
+    Nif::NIFStream stream(NULL, makeStream(data.str()));
+    Nif::FloatKeyMap keys;
+    keys.read(&stream);
+
+    ASSERT_EQ(3u, keys.size());
+    EXPECT_EQ(0.5f, keys.mTimes[0]);
+    EXPECT_EQ(20.f, keys.mValues[0]);
+    EXPECT_EQ(1.f, keys.mTimes[1]);
+    EXPECT_EQ(30.f, keys.mValues[1]);
+    EXPECT_EQ(2.f, keys.mTimes[2]);
+    EXPECT_EQ(40.f, keys.mValues[2]);
+}
+
+/// The bulk array readers have to give the same results as reading element by element.
+TEST(NIFStreamTest, arrays_match_elements)
+{
+    const size_t count = 1000;
+    std::ostringstream data;
+    for (size_t i=0; i<count*4; ++i)
+        writeFloat(data, i * 0.5f - 100.f);
+
+    for (int components=2; components<=4; ++components)
+    {
+        Nif::NIFStream elements(NULL, makeStream(data.str()));
+        Nif::NIFStream arrays(NULL, makeStream(data.str()));
+
+        if (components == 2)
+        {
+            osg::ref_ptr<osg::Vec2Array> array (new osg::Vec2Array);
+            arrays.getVector2s(array, count);
+            ASSERT_EQ(count, array->size());
+            for (size_t i=0; i<count; ++i)
+                ASSERT_EQ(elements.getVector2(), (*array)[i]);
+        }
+        else if (components == 3)
+        {
+            osg::ref_ptr<osg::Vec3Array> array (new osg::Vec3Array);
+            arrays.getVector3s(array, count);
+            ASSERT_EQ(count, array->size());
+            for (size_t i=0; i<count; ++i)
+                ASSERT_EQ(elements.getVector3(), (*array)[i]);
+        }
+        else
+        {
+            osg::ref_ptr<osg::Vec4Array> array (new osg::Vec4Array);
+            arrays.getVector4s(array, count);
+            ASSERT_EQ(count, array->size());
+            for (size_t i=0; i<count; ++i)
+                ASSERT_EQ(elements.getVector4(), (*array)[i]);
+        }
+    }
+
+    Nif::NIFStream elements(NULL, makeStream(data.str()));
+    Nif::NIFStream arrays(NULL, makeStream(data.str()));
+    std::vector<osg::Quat> quats;
+    arrays.getQuaternions(quats, count);
+    ASSERT_EQ(count, quats.size());
+    for (size_t i=0; i<count; ++i)
+        ASSERT_EQ(elements.getQuaternion(), quats[i]);
+
+    Nif::NIFStream floatElements(NULL, makeStream(data.str()));
+    Nif::NIFStream floatArrays(NULL, makeStream(data.str()));
+    std::vector<float> floats;
+    floatArrays.getFloats(floats, count);
+    ASSERT_EQ(count, floats.size());
+    for (size_t i=0; i<count; ++i)
+        ASSERT_EQ(floatElements.getFloat(), floats[i]);
+}
+
+TEST(NIFStreamTest, ushorts)
+{
+    std::string data;
+    for (int i=0; i<300; ++i)
+    {
+        data += static_cast<char>(i & 0xff);
+        data += static_cast<char>(i >> 8);
+    }
+
+    Nif::NIFStream stream(NULL, makeStream(data));
+    osg::ref_ptr<osg::DrawElementsUShort> indices (new osg::DrawElementsUShort(osg::PrimitiveSet::TRIANGLES));
+    stream.getUShorts(indices, 300);
+    ASSERT_EQ(300u, indices->size());
+    for (int i=0; i<300; ++i)
+        ASSERT_EQ(i, (*indices)[i]);
+}
+
+/// Loads every .nif file below the directory given in the OPENMW_NIF_CORPUS environment variable,
+/// e.g. the extracted meshes of Morrowind.bsa.
+TEST(NIFStreamTest, DISABLED_benchmark_corpus)
+{
+    const char* corpus = std::getenv("OPENMW_NIF_CORPUS");
+    if (!corpus)
+    {
+        std::cout << "OPENMW_NIF_CORPUS is not set, skipping" << std::endl;
+        return;
+    }
+
+    std::vector<std::pair<std::string, std::string> > files;
+    size_t totalSize = 0;
+    for (boost::filesystem::recursive_directory_iterator it(corpus), end; it != end; ++it)
+    {
+        if (!boost::filesystem::is_regular_file(*it) || Misc::StringUtils::lowerCase(it->path().extension().string()) != ".nif")
+            continue;
+
+        boost::filesystem::ifstream stream(it->path(), std::ios::binary);
+        std::ostringstream contents;
+        contents << stream.rdbuf();
+        files.push_back(std::make_pair(it->path().string(), contents.str()));
+        totalSize += files.back().second.size();
+    }
+
+    // Parse from memory, so that we measure decoding rather than the disk
+    size_t failed = 0;
+    std::clock_t start = std::clock();
+    for (size_t i=0; i<files.size(); ++i)
+    {
+        try
+        {
+            Nif::NIFFile file(makeStream(files[i].second), files[i].first);
+        }
+        catch (std::exception&)
+        {
+            ++failed;
+        }
+    }
+    std::clock_t time = std::clock() - start;
+
+    std::cout << files.size() << " files, " << totalSize / (1024*1024) << " MiB, " << failed << " failed" << std::endl;
+    std::cout << "parsing: " << time * 1000.0 / CLOCKS_PER_SEC << " ms" << std::endl;
+}
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <map>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <osg/Matrixf>
+
+#include <components/misc/stringops.hpp>
+#include <components/nif/niffile.hpp>
+#include <components/nif/node.hpp>
+#include <components/nif/data.hpp>
+#include <components/sceneutil/skinning.hpp>
+
+namespace
+{
+    float random(float min, float max)
+    {
+        return min + (max - min) * (std::rand() / static_cast<float>(RAND_MAX));
+    }
+
+    osg::Vec3f randomVec3(float min, float max)
+    {
+        return osg::Vec3f(random(min, max), random(min, max), random(min, max));
+    }
+
+    osg::Matrixf randomMatrix()
+    {
+        return osg::Matrixf::scale(osg::Vec3f(1,1,1) * random(0.5f, 2.f))
+                * osg::Matrixf::rotate(random(-3.f, 3.f), randomVec3(-1.f, 1.f))
+                * osg::Matrixf::translate(randomVec3(-100.f, 100.f));
+    }
+
+    void expectNear(const osg::Vec3f& expected, const osg::Vec3f& actual)
+    {
+        EXPECT_NEAR(expected.x(), actual.x(), 1e-3f);
+        EXPECT_NEAR(expected.y(), actual.y(), 1e-3f);
+        EXPECT_NEAR(expected.z(), actual.z(), 1e-3f);
+    }
+
+    /// Vertices of a skinned shape, sorted by bone weights the same way RigGeometry does.
+    struct SkinnedShape
+    {
+        SceneUtil::SkinningVertices mVertices;
+        std::vector<std::pair<size_t, size_t> > mGroups;
+    };
+
+    void addSkinnedShape(const Nif::NiTriShape* shape, std::vector<SkinnedShape>& shapes)
+    {
+        const Nif::NiTriShapeData* data = shape->data.getPtr();
+        const Nif::NiSkinData* skinData = shape->skin->data.getPtr();
+        if (!data->vertices || !data->normals || data->normals->size() != data->vertices->size())
+            return;
+
+        typedef std::vector<std::pair<size_t, float> > Weights;
+        std::map<unsigned short, Weights> vertexWeights;
+        for (size_t bone=0; bone<skinData->bones.size(); ++bone)
+        {
+            const std::vector<Nif::NiSkinData::VertWeight>& weights = skinData->bones[bone].weights;
+            for (size_t i=0; i<weights.size(); ++i)
+                vertexWeights[weights[i].vertex].push_back(std::make_pair(bone, weights[i].weight));
+        }
+
+        std::map<Weights, std::vector<unsigned short> > groups;
+        for (std::map<unsigned short, Weights>::const_iterator it = vertexWeights.begin(); it != vertexWeights.end(); ++it)
+        {
+            if (it->first < data->vertices->size())
+                groups[it->second].push_back(it->first);
+        }
+
+        SkinnedShape skinned;
+        for (std::map<Weights, std::vector<unsigned short> >::const_iterator it = groups.begin(); it != groups.end(); ++it)
+        {
+            size_t begin = skinned.mVertices.size();
+            for (size_t i=0; i<it->second.size(); ++i)
+                skinned.mVertices.push_back((*data->vertices)[it->second[i]], (*data->normals)[it->second[i]], it->second[i]);
+            skinned.mGroups.push_back(std::make_pair(begin, skinned.mVertices.size()));
+        }
+        shapes.push_back(skinned);
+    }
+
+    typedef void (*SkinFunction)(const osg::Matrixf&, const SceneUtil::SkinningVertices&, size_t, size_t, osg::Vec3f*, osg::Vec3f*);
+
+    double timeSkinning(SkinFunction skin, const std::vector<SkinnedShape>& shapes, int iterations)
+    {
+        osg::Matrixf matrix = randomMatrix();
+        std::vector<osg::Vec3f> positions (65536);
+        std::vector<osg::Vec3f> normals (65536);
+
+        std::clock_t start = std::clock();
+        for (int i=0; i<iterations; ++i)
+        {
+            for (std::vector<SkinnedShape>::const_iterator shape = shapes.begin(); shape != shapes.end(); ++shape)
+                for (size_t group=0; group<shape->mGroups.size(); ++group)
+                    skin(matrix, shape->mVertices, shape->mGroups[group].first, shape->mGroups[group].second, &positions[0], &normals[0]);
+        }
+        return (std::clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+    }
+}
+
+TEST(SkinningTest, matches_osg_transform)
+{
+    const size_t count = 103;
+    SceneUtil::SkinningVertices vertices;
+    for (size_t i=0; i<count; ++i)
+        vertices.push_back(randomVec3(-100.f, 100.f), randomVec3(-1.f, 1.f), static_cast<unsigned short>((i * 7) % count));
+
+    osg::Matrixf matrix = randomMatrix();
+
+    std::vector<osg::Vec3f> positions (count);
+    std::vector<osg::Vec3f> normals (count);
+    std::vector<osg::Vec3f> scalarPositions (count);
+    std::vector<osg::Vec3f> scalarNormals (count);
+
+    // use an odd range, so that the SIMD path has leftover vertices
+    SceneUtil::skinVertices(matrix, vertices, 1, count, &positions[0], &normals[0]);
+    SceneUtil::skinVerticesScalar(matrix, vertices, 1, count, &scalarPositions[0], &scalarNormals[0]);
+
+    for (size_t i=1; i<count; ++i)
+    {
+        unsigned short index = vertices.mIndices[i];
+        osg::Vec3f position (vertices.mX[i], vertices.mY[i], vertices.mZ[i]);
+        osg::Vec3f normal (vertices.mNormalX[i], vertices.mNormalY[i], vertices.mNormalZ[i]);
+
+        expectNear(matrix.preMult(position), positions[index]);
+        expectNear(osg::Matrixf::transform3x3(normal, matrix), normals[index]);
+        expectNear(scalarPositions[index], positions[index]);
+        expectNear(scalarNormals[index], normals[index]);
+    }
+}
+
+/// Skins every skinned shape of the .nif files below the directory given in the OPENMW_NIF_CORPUS
+/// environment variable, e.g. the extracted meshes/b folder of Morrowind.bsa for the NPC body parts.
+TEST(SkinningTest, DISABLED_benchmark_body_meshes)
+{
+    const char* corpus = std::getenv("OPENMW_NIF_CORPUS");
+    if (!corpus)
+    {
+        std::cout << "OPENMW_NIF_CORPUS is not set, skipping" << std::endl;
+        return;
+    }
+
+    std::vector<SkinnedShape> shapes;
+    for (boost::filesystem::recursive_directory_iterator it(corpus), end; it != end; ++it)
+    {
+        if (!boost::filesystem::is_regular_file(*it) || Misc::StringUtils::lowerCase(it->path().extension().string()) != ".nif")
+            continue;
+
+        try
+        {
+            Files::IStreamPtr stream (new boost::filesystem::ifstream(it->path(), std::ios::binary));
+            Nif::NIFFile file(stream, it->path().string());
+            for (size_t i=0; i<file.numRecords(); ++i)
+            {
+                const Nif::NiTriShape* shape = dynamic_cast<const Nif::NiTriShape*>(file.getRecord(i));
+                if (shape && !shape->data.empty() && !shape->skin.empty() && !shape->skin->data.empty())
+                    addSkinnedShape(shape, shapes);
+            }
+        }
+        catch (std::exception&)
+        {
+        }
+    }
+
+    if (shapes.empty())
+    {
+        std::cout << "No skinned shapes found" << std::endl;
+        return;
+    }
+
+    size_t vertexCount = 0;
+    for (size_t i=0; i<shapes.size(); ++i)
+        vertexCount += shapes[i].mVertices.size();
+
+    const int iterations = 100;
+    std::cout << shapes.size() << " skinned shapes, " << vertexCount << " vertices, " << iterations << " iterations" << std::endl;
+    std::cout << "scalar: " << timeSkinning(&SceneUtil::skinVerticesScalar, shapes, iterations) << " ms" << std::endl;
+    std::cout << (SceneUtil::hasSimdSkinning() ? "SIMD: " : "SIMD (not available): ")
+              << timeSkinning(&SceneUtil::skinVertices, shapes, iterations) << " ms" << std::endl;
+}
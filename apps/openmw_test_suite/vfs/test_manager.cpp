@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+
+#include <components/files/memorystream.hpp>
+#include <components/vfs/archive.hpp>
+#include <components/vfs/manager.hpp>
+
+namespace
+{
+    class TestFile : public VFS::File
+    {
+    public:
+        TestFile(const std::string& contents)
+            : mContents(contents)
+        {
+        }
+
+        virtual Files::IStreamPtr open()
+        {
+            return Files::IStreamPtr(new Files::IMemStream(mContents.c_str(), mContents.size()));
+        }
+
+    private:
+        std::string mContents;
+    };
+
+    class TestArchive : public VFS::Archive
+    {
+    public:
+        ~TestArchive()
+        {
+            for (std::map<std::string, TestFile*>::iterator it = mFiles.begin(); it != mFiles.end(); ++it)
+                delete it->second;
+        }
+
+        void add(const std::string& name)
+        {
+            TestFile*& file = mFiles[name];
+            delete file;
+            file = new TestFile(name);
+        }
+
+        virtual void listResources(std::map<std::string, VFS::File*>& out, char (*normalize_function) (char))
+        {
+            for (std::map<std::string, TestFile*>::iterator it = mFiles.begin(); it != mFiles.end(); ++it)
+            {
+                std::string ent = it->first;
+                std::transform(ent.begin(), ent.end(), ent.begin(), normalize_function);
+                out[ent] = it->second;
+            }
+        }
+
+    private:
+        std::map<std::string, TestFile*> mFiles;
+    };
+
+    std::string makeName(int i)
+    {
+        std::ostringstream stream;
+        stream << "Meshes\\Cat" << (i % 97) << "\\Mesh_" << i << ".NIF";
+        return stream.str();
+    }
+
+    std::string readAll(Files::IStreamPtr stream)
+    {
+        std::string contents;
+        std::getline(*stream, contents, '\0');
+        return contents;
+    }
+
+    const int sNumFiles = 100000;
+}
+
+struct VFSManagerTest : public ::testing::Test
+{
+    VFSManagerTest()
+        : mManager(false)
+    {
+    }
+
+    virtual void SetUp()
+    {
+        TestArchive* archive = new TestArchive;
+        for (int i=0; i<sNumFiles; ++i)
+            archive->add(makeName(i));
+        mManager.addArchive(archive);
+        mManager.buildIndex();
+    }
+
+    VFS::Manager mManager;
+};
+
+TEST_F(VFSManagerTest, index_contains_all_files)
+{
+    ASSERT_EQ(static_cast<size_t>(sNumFiles), mManager.getIndex().size());
+    for (int i=0; i<sNumFiles; ++i)
+        EXPECT_TRUE(mManager.exists(makeName(i)));
+}
+
+TEST_F(VFSManagerTest, lookup_is_case_and_slash_insensitive)
+{
+    EXPECT_TRUE(mManager.exists("meshes/cat5/mesh_5.nif"));
+    EXPECT_TRUE(mManager.exists("MESHES/CAT5\\MESH_5.nif"));
+    EXPECT_EQ("Meshes\\Cat5\\Mesh_5.NIF", readAll(mManager.get("meshes/cat5/mesh_5.nif")));
+}
+
+TEST_F(VFSManagerTest, normalized_lookup_does_not_normalize)
+{
+    const char name[] = "meshes/cat7/mesh_7.nifXYZ";
+    EXPECT_TRUE(mManager.existsNormalized(name, sizeof(name)-4));
+    EXPECT_EQ("Meshes\\Cat7\\Mesh_7.NIF", readAll(mManager.getNormalized(name, sizeof(name)-4)));
+    EXPECT_FALSE(mManager.existsNormalized("Meshes/cat7/mesh_7.nif", sizeof(name)-4));
+}
+
+TEST_F(VFSManagerTest, missing_files_are_not_found)
+{
+    EXPECT_FALSE(mManager.exists("meshes/cat5/mesh_6.nif"));
+    EXPECT_FALSE(mManager.exists("meshes/cat5/mesh_5.ni"));
+    EXPECT_FALSE(mManager.exists(""));
+    EXPECT_THROW(mManager.get("meshes/cat5/mesh_6.nif"), std::runtime_error);
+}
+
+TEST(VFSManagerEmptyTest, lookup_in_empty_index)
+{
+    VFS::Manager manager(true);
+    EXPECT_FALSE(manager.exists("a"));
+    manager.buildIndex();
+    EXPECT_FALSE(manager.exists("a"));
+}
+
+/// Microbenchmark of the hashed lookup against a std::map lookup of the same keys.
+/// Run with --gtest_also_run_disabled_tests.
+TEST_F(VFSManagerTest, DISABLED_benchmark_lookup)
+{
+    const std::map<std::string, VFS::File*>& index = mManager.getIndex();
+    std::vector<std::string> keys;
+    for (std::map<std::string, VFS::File*>::const_iterator it = index.begin(); it != index.end(); ++it)
+        keys.push_back(it->first);
+    // Lookups during loading don't arrive in sorted order
+    std::random_shuffle(keys.begin(), keys.end());
+
+    const int rounds = 10;
+    size_t found = 0;
+
+    std::clock_t start = std::clock();
+    for (int round=0; round<rounds; ++round)
+        for (size_t i=0; i<keys.size(); ++i)
+            found += index.find(keys[i]) != index.end();
+    std::clock_t mapTime = std::clock() - start;
+
+    start = std::clock();
+    for (int round=0; round<rounds; ++round)
+        for (size_t i=0; i<keys.size(); ++i)
+            found += mManager.existsNormalized(keys[i].c_str(), keys[i].size());
+    std::clock_t hashTime = std::clock() - start;
+
+    start = std::clock();
+    for (int round=0; round<rounds; ++round)
+        for (size_t i=0; i<keys.size(); ++i)
+            found += mManager.exists(keys[i]);
+    std::clock_t hashNormalizeTime = std::clock() - start;
+
+    EXPECT_EQ(keys.size() * rounds * 3, found);
+
+    const double lookups = static_cast<double>(keys.size() * rounds);
+    std::cout << "std::map find: " << mapTime * 1e9 / CLOCKS_PER_SEC / lookups << " ns/lookup" << std::endl;
+    std::cout << "existsNormalized: " << hashTime * 1e9 / CLOCKS_PER_SEC / lookups << " ns/lookup" << std::endl;
+    std::cout << "exists: " << hashNormalizeTime * 1e9 / CLOCKS_PER_SEC / lookups << " ns/lookup" << std::endl;
+}
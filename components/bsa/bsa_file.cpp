@@ -24,13 +24,43 @@
 #include "bsa_file.hpp"
 
 #include <stdexcept>
+#include <iostream>
+#include <cassert>
 
 #include <boost/filesystem/path.hpp>
 #include <boost/filesystem/fstream.hpp>
 
+#include <components/misc/stringops.hpp>
+
 using namespace std;
 using namespace Bsa;
 
+namespace
+{
+    /// Case insensitive FNV-1a hash of a file name
+    uint32_t hashName(const char *name)
+    {
+        uint32_t hash = 2166136261u;
+        for (; *name; ++name)
+        {
+            hash ^= static_cast<unsigned char>(Misc::StringUtils::toLower(*name));
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    /// Case insensitive string comparison that does not allocate
+    bool nameEquals(const char *s1, const char *s2)
+    {
+        for (; *s1 && *s2; ++s1, ++s2)
+        {
+            if (Misc::StringUtils::toLower(*s1) != Misc::StringUtils::toLower(*s2))
+                return false;
+        }
+        return *s1 == *s2;
+    }
+}
+
 
 /// Error handling
 void BSAFile::fail(const string &msg)
@@ -74,7 +104,12 @@ void BSAFile::readHeader()
     assert(!isLoaded);
 
     namespace bfs = boost::filesystem;
-    bfs::ifstream input(bfs::path(filename), std::ios_base::binary);
+    Files::IStreamPtr inputPtr;
+    if (mapping)
+        inputPtr = Files::openMappedFileStream(mapping, 0, mapping->size());
+    else
+        inputPtr.reset(new bfs::ifstream(bfs::path(filename), std::ios_base::binary));
+    std::istream &input = *inputPtr;
 
     // Total archive size
     std::streamoff fsize = 0;
@@ -112,57 +147,117 @@ void BSAFile::readHeader()
     if((filenum*21 > unsigned(fsize -12)) || (dirsize+8*filenum > unsigned(fsize -12)) )
         fail("Directory information larger than entire archive");
 
+    // The string table follows the offsets within the directory block
+    if(dirsize < 12*filenum)
+        fail("Directory information larger than entire archive");
+
     // Read the offset info into a temporary buffer
     std::vector<uint32_t> offsets(3*filenum);
     input.read(reinterpret_cast<char*>(&offsets[0]), 12*filenum);
 
-    // Read the string table
-    stringBuf.resize(dirsize-12*filenum);
-    input.read(&stringBuf[0], stringBuf.size());
+    // Read the string table. A mapped archive can use the names in place.
+    size_t namesSize = dirsize-12*filenum;
+    const char *names = NULL;
+    if (mapping)
+        names = mapping->data() + 12 + 12*filenum;
+    else
+    {
+        stringBuf.resize(namesSize);
+        input.read(&stringBuf[0], stringBuf.size());
+        names = &stringBuf[0];
 
-    // Check our position
-    assert(input.tellg() == std::streampos(12+dirsize));
+        // Check our position
+        assert(input.tellg() == std::streampos(12+dirsize));
+    }
 
     // Calculate the offset of the data buffer. All file offsets are
     // relative to this. 12 header bytes + directory + hash table
     // (skipped)
     size_t fileDataOffset = 12 + dirsize + 8*filenum;
 
+    // Size the lookup table to a power of two with a load factor of at most 1/2
+    size_t tableSize = 16;
+    while (tableSize < filenum*2)
+        tableSize *= 2;
+    lookup.assign(tableSize, -1);
+
     // Set up the the FileStruct table
     files.resize(filenum);
+    hashes.resize(filenum);
     for(size_t i=0;i<filenum;i++)
     {
         FileStruct &fs = files[i];
         fs.fileSize = offsets[i*2];
         fs.offset = offsets[i*2+1] + fileDataOffset;
-        fs.name = &stringBuf[offsets[2*filenum+i]];
+
+        if(offsets[2*filenum+i] >= namesSize)
+            fail("Archive contains file names outside itself");
+        fs.name = names + offsets[2*filenum+i];
 
         if(fs.offset + fs.fileSize > fsize)
             fail("Archive contains offsets outside itself");
 
         // Add the file name to the lookup
-        lookup[fs.name] = i;
+        hashes[i] = hashName(fs.name);
+        addToLookup(i);
     }
 
     isLoaded = true;
 }
 
+/// Add files[index] to the lookup table
+void BSAFile::addToLookup(int index)
+{
+    const size_t mask = lookup.size()-1;
+    for (size_t slot = hashes[index] & mask;; slot = (slot+1) & mask)
+    {
+        int &entry = lookup[slot];
+        // Later entries with the same name replace earlier ones
+        if (entry == -1 || (hashes[entry] == hashes[index] && nameEquals(files[entry].name, files[index].name)))
+        {
+            entry = index;
+            return;
+        }
+    }
+}
+
 /// Get the index of a given file name, or -1 if not found
 int BSAFile::getIndex(const char *str) const
 {
-    Lookup::const_iterator it = lookup.find(str);
-    if(it == lookup.end())
+    if (lookup.empty())
         return -1;
 
-    int res = it->second;
-    assert(res >= 0 && (size_t)res < files.size());
-    return res;
+    const uint32_t hash = hashName(str);
+    const size_t mask = lookup.size()-1;
+    for (size_t slot = hash & mask; lookup[slot] != -1; slot = (slot+1) & mask)
+    {
+        int res = lookup[slot];
+        assert(res >= 0 && (size_t)res < files.size());
+        if (hashes[res] == hash && nameEquals(files[res].name, str))
+            return res;
+    }
+    return -1;
 }
 
 /// Open an archive file.
-void BSAFile::open(const string &file)
+void BSAFile::open(const string &file, bool memoryMapped)
 {
     filename = file;
+
+    if (memoryMapped)
+    {
+        try
+        {
+            Files::MappedFilePtr mapped(new Files::MappedFile);
+            mapped->open(file);
+            mapping = mapped;
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "Warning: " << e.what() << ", reading '" << file << "' through file streams instead" << std::endl;
+        }
+    }
+
     readHeader();
 }
 
@@ -173,12 +268,13 @@ Files::IStreamPtr BSAFile::getFile(const char *file)
     if(i == -1)
         fail("File not found: " + string(file));
 
-    const FileStruct &fs = files[i];
-
-    return Files::openConstrainedFileStream (filename.c_str (), fs.offset, fs.fileSize);
+    return getFile(&files[i]);
 }
 
 Files::IStreamPtr BSAFile::getFile(const FileStruct *file)
 {
+    if (mapping)
+        return Files::openMappedFileStream (mapping, file->offset, file->fileSize);
+
     return Files::openConstrainedFileStream (filename.c_str (), file->offset, file->fileSize);
 }
@@ -27,11 +27,9 @@
 #include <stdint.h>
 #include <string>
 #include <vector>
-#include <map>
-
-#include <components/misc/stringops.hpp>
 
 #include <components/files/constrainedfilestream.hpp>
+#include <components/files/mappedfile.hpp>
 
 
 namespace Bsa
@@ -69,19 +67,17 @@ private:
     /// Used for error messages
     std::string filename;
 
-    /// Case insensitive string comparison
-    struct iltstr
-    {
-        bool operator()(const char *s1, const char *s2) const
-        { return Misc::StringUtils::ciLess(s1, s2); }
-    };
+    /// The archive mapped into memory, or empty when reading through file streams
+    Files::MappedFilePtr mapping;
 
-    /** A map used for fast file name lookup. The value is the index into
-        the files[] vector above. The iltstr ensures that file name
-        checks are case insensitive.
+    /// Case insensitive hash of each file name, parallel to files[]
+    std::vector<uint32_t> hashes;
+
+    /** An open addressing hash table used for fast file name lookup. Each
+        slot holds an index into the files[] vector above, or -1 if the
+        slot is empty. The size is always a power of two.
     */
-    typedef std::map<const char*, int, iltstr> Lookup;
-    Lookup lookup;
+    std::vector<int> lookup;
 
     /// Error handling
     void fail(const std::string &msg);
@@ -89,6 +85,9 @@ private:
     /// Read header information from the input source
     void readHeader();
 
+    /// Add files[index] to the lookup table
+    void addToLookup(int index);
+
     /// Get the index of a given file name, or -1 if not found
     /// @note Thread safe.
     int getIndex(const char *str) const;
@@ -104,7 +103,13 @@ public:
     { }
 
     /// Open an archive file.
-    void open(const std::string &file);
+    /// @param memoryMapped Map the whole archive into memory, so getFile() returns streams reading
+    /// straight from the mapping. Falls back to file streams if the archive can not be mapped.
+    void open(const std::string &file, bool memoryMapped = false);
+
+    /// Is the archive mapped into memory?
+    bool isMemoryMapped() const
+    { return mapping.get() != NULL; }
 
     /* -----------------------------------
      * Archive file routines
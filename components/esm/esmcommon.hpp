@@ -7,6 +7,13 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <boost/shared_ptr.hpp>
+
+namespace Files
+{
+    class MappedFile;
+}
+
 namespace ESM
 {
 enum Version
@@ -15,6 +22,10 @@ enum Version
     VER_13 = 0x3fa66666
   };
 
+/// Record flag of records whose data is compressed with zlib (see ESMWriter::setCompressed).
+/// The record data then consists of the size of the uncompressed data, followed by the compressed data.
+const uint32_t FLAG_Compressed = 0x00040000;
+
 /* A structure used for holding fixed-length strings. In the case of
    LEN=4, it can be more efficient to match the string as a 32 bit
    number, therefore the struct is implemented as a union with an int.
@@ -75,6 +86,10 @@ struct ESM_Context
   // File position. Only used for stored contexts, not regularly
   // updated within the reader itself.
   size_t filePos;
+
+  // Set if the file was opened memory-mapped. Restoring the context then reuses the
+  // mapping instead of reopening the file.
+  boost::shared_ptr<Files::MappedFile> mapping;
 };
 
 }
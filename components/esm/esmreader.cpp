@@ -2,6 +2,8 @@
 
 #include <stdexcept>
 
+#include <zlib.h>
+
 namespace ESM
 {
 
@@ -15,12 +17,15 @@ using namespace Misc;
 ESM_Context ESMReader::getContext()
 {
     // Update the file position before returning
-    mCtx.filePos = mEsm->tellg();
+    mCtx.filePos = getFileOffset();
     return mCtx;
 }
 
 ESMReader::ESMReader()
     : mIdx(0)
+    , mPos(0)
+    , mRecordPos(0)
+    , mCompressedRecord(false)
     , mRecordFlags(0)
     , mBuffer(50*1024)
     , mGlobalReaderList(NULL)
@@ -36,8 +41,24 @@ int ESMReader::getFormat() const
 
 void ESMReader::restoreContext(const ESM_Context &rc)
 {
+    mCompressedRecord = false;
+
+    if (rc.mapping)
+    {
+        // Take over the context's mapping, unless we have one of the same file already
+        if (!mMapping || mCtx.filename != rc.filename)
+            openRaw(rc.mapping, rc.filename);
+
+        Files::MappedFilePtr mapping = mMapping;
+        mCtx = rc;
+        mCtx.mapping = mapping;
+
+        mPos = mCtx.filePos;
+        return;
+    }
+
     // Reopen the file if necessary
-    if (mCtx.filename != rc.filename)
+    if (mCtx.filename != rc.filename || mMapping)
         openRaw(rc.filename);
 
     // Copy the data
@@ -50,6 +71,12 @@ void ESMReader::restoreContext(const ESM_Context &rc)
 void ESMReader::close()
 {
     mEsm.reset();
+    mMapping.reset();
+    mCtx.mapping.reset();
+    mPos = 0;
+    mCompressedRecord = false;
+    mRecordData.clear();
+    mRecordPos = 0;
     mCtx.filename.clear();
     mCtx.leftFile = 0;
     mCtx.leftRec = 0;
@@ -69,9 +96,25 @@ void ESMReader::openRaw(Files::IStreamPtr _esm, const std::string& name)
     mEsm->seekg(0, mEsm->beg);
 }
 
-void ESMReader::openRaw(const std::string& filename)
+void ESMReader::openRaw(Files::MappedFilePtr mapping, const std::string& name)
 {
-    openRaw(Files::openConstrainedFileStream(filename.c_str()), filename);
+    close();
+    mMapping = mapping;
+    mCtx.mapping = mapping;
+    mCtx.filename = name;
+    mCtx.leftFile = mFileSize = mapping->size();
+}
+
+void ESMReader::openRaw(const std::string& filename, bool memoryMapped)
+{
+    if (memoryMapped)
+    {
+        Files::MappedFilePtr mapping (new Files::MappedFile);
+        mapping->open(filename);
+        openRaw(mapping, filename);
+    }
+    else
+        openRaw(Files::openConstrainedFileStream(filename.c_str()), filename);
 }
 
 void ESMReader::open(Files::IStreamPtr _esm, const std::string &name)
@@ -86,9 +129,16 @@ void ESMReader::open(Files::IStreamPtr _esm, const std::string &name)
     mHeader.load (*this);
 }
 
-void ESMReader::open(const std::string &file)
+void ESMReader::open(const std::string &file, bool memoryMapped)
 {
-    open (Files::openConstrainedFileStream (file.c_str ()), file);
+    openRaw(file, memoryMapped);
+
+    if (getRecName() != "TES3")
+        fail("Not a valid Morrowind file");
+
+    getRecHeader();
+
+    mHeader.load (*this);
 }
 
 int64_t ESMReader::getHNLong(const char *name)
@@ -266,6 +316,8 @@ NAME ESMReader::getRecName()
 {
     if (!hasMoreRecs())
         fail("No more records, getRecName() failed");
+    // the previous record is done, continue in the file
+    mCompressedRecord = false;
     getName(mCtx.recName);
     mCtx.leftFile -= 4;
 
@@ -303,6 +355,32 @@ void ESMReader::getRecHeader(uint32_t &flags)
 
     // Adjust number of bytes mCtx.left in file
     mCtx.leftFile -= mCtx.leftRec;
+
+    if (flags & FLAG_Compressed)
+        decompressRecord();
+}
+
+void ESMReader::decompressRecord()
+{
+    uint32_t size;
+    if (mCtx.leftRec < sizeof(size))
+        fail("Compressed record is too small");
+    getUint(size);
+
+    uLong compressedSize = mCtx.leftRec - sizeof(size);
+    const char* compressed = getSpan(static_cast<int>(compressedSize));
+
+    // one byte of padding, so that the buffer is never empty
+    mRecordData.resize(static_cast<size_t>(size) + 1);
+    uLongf uncompressedSize = size;
+    if (uncompress(reinterpret_cast<Bytef*>(&mRecordData[0]), &uncompressedSize,
+                   reinterpret_cast<const Bytef*>(compressed), compressedSize) != Z_OK
+            || uncompressedSize != size)
+        fail("Failed to decompress record");
+
+    mCtx.leftRec = size;
+    mRecordPos = 0;
+    mCompressedRecord = true;
 }
 
 /*************************************************************************
@@ -313,6 +391,21 @@ void ESMReader::getRecHeader(uint32_t &flags)
 
 void ESMReader::getExact(void*x, int size)
 {
+    if (mCompressedRecord)
+    {
+        memcpy(x, getSpan(size), size);
+        return;
+    }
+
+    if (mMapping)
+    {
+        if (size < 0 || static_cast<size_t>(size) > mFileSize - mPos)
+            fail("Read error: unexpected end of file");
+        memcpy(x, mMapping->data() + mPos, size);
+        mPos += size;
+        return;
+    }
+
     try
     {
         mEsm->read((char*)x, size);
@@ -323,8 +416,27 @@ void ESMReader::getExact(void*x, int size)
     }
 }
 
-std::string ESMReader::getString(int size)
+const char* ESMReader::getSpan(int size)
 {
+    if (mCompressedRecord)
+    {
+        // mRecordData has one byte of padding, see decompressRecord()
+        if (size < 0 || static_cast<size_t>(size) > mRecordData.size() - 1 - mRecordPos)
+            fail("Read error: unexpected end of record");
+        const char* ptr = &mRecordData[mRecordPos];
+        mRecordPos += size;
+        return ptr;
+    }
+
+    if (mMapping)
+    {
+        if (size < 0 || static_cast<size_t>(size) > mFileSize - mPos)
+            fail("Read error: unexpected end of file");
+        const char* ptr = mMapping->data() + mPos;
+        mPos += size;
+        return ptr;
+    }
+
     size_t s = size;
     if (mBuffer.size() <= s)
         // Add some extra padding to reduce the chance of having to resize
@@ -337,6 +449,12 @@ std::string ESMReader::getString(int size)
     // read ESM data
     char *ptr = &mBuffer[0];
     getExact(ptr, size);
+    return ptr;
+}
+
+std::string ESMReader::getString(int size)
+{
+    const char *ptr = getSpan(size);
 
     size = strnlen(ptr, size);
 
@@ -357,8 +475,8 @@ void ESMReader::fail(const std::string &msg)
     ss << "\n  File: " << mCtx.filename;
     ss << "\n  Record: " << mCtx.recName.toString();
     ss << "\n  Subrecord: " << mCtx.subName.toString();
-    if (mEsm.get())
-        ss << "\n  Offset: 0x" << hex << mEsm->tellg();
+    if (mEsm.get() || mMapping)
+        ss << "\n  Offset: 0x" << hex << getFileOffset();
     throw std::runtime_error(ss.str());
 }
 
@@ -369,11 +487,26 @@ void ESMReader::setEncoder(ToUTF8::Utf8Encoder* encoder)
 
 size_t ESMReader::getFileOffset()
 {
+    if (mMapping)
+        return mPos;
     return mEsm->tellg();
 }
 
 void ESMReader::skip(int bytes)
 {
+    if (mCompressedRecord)
+    {
+        getSpan(bytes);
+        return;
+    }
+
+    if (mMapping)
+    {
+        if (bytes < 0 || static_cast<size_t>(bytes) > mFileSize - mPos)
+            fail("Read error: unexpected end of file");
+        mPos += bytes;
+        return;
+    }
     mEsm->seekg(getFileOffset()+bytes);
 }
 
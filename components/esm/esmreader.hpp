@@ -8,6 +8,7 @@
 #include <sstream>
 
 #include <components/files/constrainedfilestream.hpp>
+#include <components/files/mappedfile.hpp>
 
 #include <components/misc/stringops.hpp>
 
@@ -69,11 +70,20 @@ public:
   /// currently open file first, if any.
   void open(Files::IStreamPtr _esm, const std::string &name);
 
-  void open(const std::string &file);
+  /// @param memoryMapped Map the whole file into memory and read from the mapping, rather than through a stream.
+  /// Reading is then a plain copy from memory, strings are converted straight from the mapping, and restoring
+  /// a context is a pointer reset. The mapping is kept alive by the contexts taken from this reader.
+  void open(const std::string &file, bool memoryMapped=false);
 
-  void openRaw(const std::string &filename);
+  void openRaw(const std::string &filename, bool memoryMapped=false);
+
+  /// Raw opening of a memory-mapped file.
+  void openRaw(Files::MappedFilePtr mapping, const std::string &name);
+
+  bool isMemoryMapped() const { return mMapping.get() != NULL; }
 
   /// Get the current position in the file. Make sure that the file has been opened!
+  /// @note Within a compressed record, this is the position after the record.
   size_t getFileOffset();
 
   // This is a quick hack for multiple esm/esp files. Each plugin introduces its own
@@ -230,6 +240,8 @@ public:
   /* Read record header. This updatesleftFile BEYOND the data that
      follows the header, ie beyond the entire record. You should use
      leftRec to orient yourself inside the record itself.
+     The data of compressed records (see FLAG_Compressed) is decompressed
+     here, leftRec is then the size of the uncompressed data.
   */
   void getRecHeader() { getRecHeader(mRecordFlags); }
   void getRecHeader(uint32_t &flags);
@@ -251,6 +263,11 @@ public:
   void getName(NAME &name) { getT(name); }
   void getUint(uint32_t &u) { getT(u); }
 
+  /// Read the next 'size' bytes without copying them where possible. In memory-mapped mode
+  /// the returned pointer points into the mapping, otherwise the bytes are read into an internal buffer.
+  /// @note The data is only valid until the next read from this reader.
+  const char* getSpan(int size);
+
   // Read the next 'size' bytes and return them as a string. Converts
   // them from native encoding to UTF8 in the process.
   std::string getString(int size);
@@ -269,8 +286,19 @@ public:
   size_t getFileSize() const { return mFileSize; }
 
 private:
+  void decompressRecord();
+
   Files::IStreamPtr mEsm;
 
+  // Set in memory-mapped mode, instead of mEsm
+  Files::MappedFilePtr mMapping;
+  size_t mPos;
+
+  // Data of the current record, if it is compressed. Reads come from here instead of the file until the next record.
+  std::vector<char> mRecordData;
+  size_t mRecordPos;
+  bool mCompressedRecord;
+
   ESM_Context mCtx;
 
   unsigned int mRecordFlags;
@@ -4,12 +4,16 @@
 #include <fstream>
 #include <stdexcept>
 
+#include <zlib.h>
+
 #include <components/to_utf8/to_utf8.hpp>
 
 namespace ESM
 {
     ESMWriter::ESMWriter()
         : mStream(NULL)
+        , mCompressed(false)
+        , mFileStream(NULL)
         , mEncoder (0)
         , mRecordCount (0)
         , mCounting (true)
@@ -63,6 +67,11 @@ namespace ESM
         mHeader.mMaster.push_back(d);
     }
 
+    void ESMWriter::setCompressed(bool compressed)
+    {
+        mCompressed = compressed;
+    }
+
     void ESMWriter::save(std::ostream& file)
     {
         mRecordCount = 0;
@@ -92,12 +101,22 @@ namespace ESM
         rec.name = name;
         rec.position = mStream->tellp();
         rec.size = 0;
+        rec.compressed = mCompressed && mRecords.empty();
         writeT<uint32_t>(0); // Size goes here
         writeT<uint32_t>(0); // Unused header?
-        writeT(flags);
+        writeT(rec.compressed ? (flags | FLAG_Compressed) : flags);
         mRecords.push_back(rec);
 
         assert(mRecords.back().size == 0);
+
+        if (rec.compressed)
+        {
+            // Collect the record data, so it can be compressed in one go once the record is complete
+            mRecordBuffer.str(std::string());
+            mRecordBuffer.clear();
+            mFileStream = mStream;
+            mStream = &mRecordBuffer;
+        }
     }
 
     void ESMWriter::startRecord (uint32_t name, uint32_t flags)
@@ -120,6 +139,7 @@ namespace ESM
         rec.name = name;
         rec.position = mStream->tellp();
         rec.size = 0;
+        rec.compressed = false;
         writeT<uint32_t>(0); // Size goes here
         mRecords.push_back(rec);
 
@@ -132,6 +152,26 @@ namespace ESM
         assert(rec.name == name);
         mRecords.pop_back();
 
+        if (rec.compressed)
+        {
+            std::string data = mRecordBuffer.str();
+            mStream = mFileStream;
+            mFileStream = NULL;
+
+            uLongf compressedSize = compressBound(data.size());
+            mCompressBuffer.resize(compressedSize + 1);
+            // favour speed, this runs on the thread serializing the records, usually the main thread
+            if (compress2(reinterpret_cast<Bytef*>(&mCompressBuffer[0]), &compressedSize,
+                          reinterpret_cast<const Bytef*>(data.data()), data.size(), Z_BEST_SPEED) != Z_OK)
+                throw std::runtime_error ("Failed to compress record " + name);
+
+            uint32_t size = static_cast<uint32_t>(data.size());
+            mStream->write(reinterpret_cast<const char*>(&size), sizeof(uint32_t));
+            mStream->write(&mCompressBuffer[0], compressedSize);
+
+            rec.size = sizeof(uint32_t) + compressedSize;
+        }
+
         mStream->seekp(rec.position);
 
         mCounting = false;
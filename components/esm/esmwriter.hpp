@@ -3,6 +3,8 @@
 
 #include <iosfwd>
 #include <list>
+#include <sstream>
+#include <vector>
 
 #include "esmcommon.hpp"
 #include "loadtes3.hpp"
@@ -21,6 +23,7 @@ class ESMWriter
             std::string name;
             std::streampos position;
             uint32_t size;
+            bool compressed;
         };
 
     public:
@@ -49,6 +52,11 @@ class ESMWriter
 
         void addMaster(const std::string& name, uint64_t size);
 
+        /// Compress the data of the records started from now on, until disabled again.
+        /// Each record is compressed on its own, so that readers can still skip records without decompressing them.
+        /// @note Not supported by the original engine, only use for saved games.
+        void setCompressed(bool compressed);
+
         void save(std::ostream& file);
         ///< Start saving a file by writing the TES3 header.
 
@@ -129,6 +137,13 @@ public:
     private:
         std::list<RecordData> mRecords;
         std::ostream* mStream;
+
+        bool mCompressed;
+        // While writing a compressed record, mStream points to mRecordBuffer and the actual stream is kept here
+        std::ostream* mFileStream;
+        std::stringstream mRecordBuffer;
+        std::vector<char> mCompressBuffer;
+
         std::streampos mHeaderPos;
         ToUTF8::Utf8Encoder* mEncoder;
         int mRecordCount;
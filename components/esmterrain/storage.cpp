@@ -1,5 +1,6 @@
 #include "storage.hpp"
 
+#include <cstring>
 #include <set>
 #include <iostream>
 
@@ -343,12 +344,11 @@ namespace ESMTerrain
 
         int rowStart = (origin.x() - cellX) * realTextureSize;
         int colStart = (origin.y() - cellY) * realTextureSize;
-        int rowEnd = rowStart + chunkSize * (realTextureSize-1) + 1;
-        int colEnd = colStart + chunkSize * (realTextureSize-1) + 1;
+        const int blendmapSize = (realTextureSize-1) * chunkSize + 1;
 
         assert (rowStart >= 0 && colStart >= 0);
-        assert (rowEnd <= realTextureSize);
-        assert (colEnd <= realTextureSize);
+        assert (rowStart + blendmapSize <= realTextureSize);
+        assert (colStart + blendmapSize <= realTextureSize);
 
         // Save the used texture indices so we know the total number of textures
         // and number of required blend maps
@@ -359,11 +359,15 @@ namespace ESMTerrain
         // So we're always adding _land_default.dds as the base layer here, even if it's not referenced in this cell.
         textureIndices.insert(std::make_pair(0,0));
 
-        for (int y=colStart; y<colEnd; ++y)
-            for (int x=rowStart; x<rowEnd; ++x)
+        // Remember the texture of each texel, so the blend maps can be filled without looking them up again
+        std::vector<UniqueTextureId> texels;
+        texels.reserve(blendmapSize*blendmapSize);
+        for (int y=0; y<blendmapSize; ++y)
+            for (int x=0; x<blendmapSize; ++x)
             {
-                UniqueTextureId id = getVtexIndexAt(cellX, cellY, x, y);
+                UniqueTextureId id = getVtexIndexAt(cellX, cellY, x+rowStart, y+colStart);
                 textureIndices.insert(id);
+                texels.push_back(id);
             }
 
         // Makes sure the indices are sorted, or rather,
@@ -383,35 +387,37 @@ namespace ESMTerrain
 
         int channels = pack ? 4 : 1;
 
-        // Second iteration - create and fill in the blend maps
-        const int blendmapSize = (realTextureSize-1) * chunkSize + 1;
-
+        // Create the blend maps, then fill them in a single pass
+        GLenum format = pack ? GL_RGBA : GL_ALPHA;
         for (int i=0; i<numBlendmaps; ++i)
         {
-            GLenum format = pack ? GL_RGBA : GL_ALPHA;
-
             osg::ref_ptr<osg::Image> image (new osg::Image);
             image->allocateImage(blendmapSize, blendmapSize, 1, format, GL_UNSIGNED_BYTE);
-            unsigned char* pData = image->data();
+            memset(image->data(), 0, image->getTotalSizeInBytes());
+            blendmaps.push_back(image);
+        }
 
-            for (int y=0; y<blendmapSize; ++y)
+        // Each texel is opaque in the one channel of the one blend map of its layer, and transparent everywhere else
+        int layerIndex = 0;
+        for (int y=0; y<blendmapSize; ++y)
+        {
+            const UniqueTextureId* row = &texels[y*blendmapSize];
+            for (int x=0; x<blendmapSize; ++x)
             {
-                for (int x=0; x<blendmapSize; ++x)
+                // neighbouring texels mostly share their texture
+                if (x == 0 || row[x] != row[x-1])
                 {
-                    UniqueTextureId id = getVtexIndexAt(cellX, cellY, x+rowStart, y+colStart);
-                    assert(textureIndicesMap.find(id) != textureIndicesMap.end());
-                    int layerIndex = textureIndicesMap.find(id)->second;
-                    int blendIndex = (pack ? static_cast<int>(std::floor((layerIndex - 1) / 4.f)) : layerIndex - 1);
-                    int channel = pack ? std::max(0, (layerIndex-1) % 4) : 0;
-
-                    if (blendIndex == i)
-                        pData[(blendmapSize - y - 1)*blendmapSize*channels + x*channels + channel] = 255;
-                    else
-                        pData[(blendmapSize - y - 1)*blendmapSize*channels + x*channels + channel] = 0;
+                    assert(textureIndicesMap.find(row[x]) != textureIndicesMap.end());
+                    layerIndex = textureIndicesMap.find(row[x])->second;
                 }
-            }
+                if (layerIndex == 0)
+                    continue; // the base layer doesn't need blending
 
-            blendmaps.push_back(image);
+                int blendIndex = pack ? (layerIndex - 1) / 4 : layerIndex - 1;
+                int channel = pack ? (layerIndex - 1) % 4 : 0;
+                unsigned char* data = blendmaps[blendmaps.size() - numBlendmaps + blendIndex]->data();
+                data[(blendmapSize - y - 1)*blendmapSize*channels + x*channels + channel] = 255;
+            }
         }
     }
 
@@ -0,0 +1,257 @@
+#include "mappedfile.hpp"
+
+#include <stdexcept>
+#include <sstream>
+#include <cassert>
+
+#if FILE_API == FILE_API_POSIX
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#elif FILE_API == FILE_API_WIN32
+#include <boost/locale.hpp>
+#endif
+
+namespace Files
+{
+
+#if FILE_API == FILE_API_STDIO
+/*
+ *
+ *  Fallback: read the whole file through c stdio
+ *
+ */
+
+MappedFile::MappedFile()
+    : mOpen(false)
+    , mData(NULL)
+    , mSize(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    if (mOpen)
+        close();
+}
+
+void MappedFile::open(const std::string& filename)
+{
+    assert(!mOpen);
+
+    LowLevelFile file;
+    file.open(filename.c_str());
+
+    mBuffer.resize(file.size());
+    size_t got = 0;
+    while (got < mBuffer.size())
+    {
+        size_t read = file.read(&mBuffer[got], mBuffer.size() - got);
+        if (read == 0)
+            throw std::runtime_error("Unexpected end of file while reading '" + filename + "'");
+        got += read;
+    }
+
+    mSize = mBuffer.size();
+    mData = mSize ? &mBuffer[0] : NULL;
+    mOpen = true;
+}
+
+void MappedFile::close()
+{
+    assert(mOpen);
+
+    std::vector<char>().swap(mBuffer);
+    mData = NULL;
+    mSize = 0;
+    mOpen = false;
+}
+
+#elif FILE_API == FILE_API_POSIX
+/*
+ *
+ *  Implementation of MappedFile using mmap()
+ *
+ */
+
+MappedFile::MappedFile()
+    : mOpen(false)
+    , mData(NULL)
+    , mSize(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    if (mOpen)
+        close();
+}
+
+void MappedFile::open(const std::string& filename)
+{
+    assert(!mOpen);
+
+#ifdef O_BINARY
+    static const int openFlags = O_RDONLY | O_BINARY;
+#else
+    static const int openFlags = O_RDONLY;
+#endif
+
+    int handle = ::open(filename.c_str(), openFlags, 0);
+    if (handle == -1)
+    {
+        std::ostringstream os;
+        os << "Failed to open '" << filename << "' for reading: " << strerror(errno);
+        throw std::runtime_error(os.str());
+    }
+
+    struct stat info;
+    if (::fstat(handle, &info) == -1)
+    {
+        std::ostringstream os;
+        os << "An fstat() call on '" << filename << "' failed: " << strerror(errno);
+        ::close(handle);
+        throw std::runtime_error(os.str());
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    void* data = NULL;
+    if (size != 0)
+    {
+        data = ::mmap(NULL, size, PROT_READ, MAP_SHARED, handle, 0);
+        if (data == MAP_FAILED)
+        {
+            std::ostringstream os;
+            os << "Failed to map '" << filename << "' into memory: " << strerror(errno);
+            ::close(handle);
+            throw std::runtime_error(os.str());
+        }
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    ::close(handle);
+
+    mData = static_cast<const char*>(data);
+    mSize = size;
+    mOpen = true;
+}
+
+void MappedFile::close()
+{
+    assert(mOpen);
+
+    if (mData)
+        ::munmap(const_cast<char*>(mData), mSize);
+
+    mData = NULL;
+    mSize = 0;
+    mOpen = false;
+}
+
+#elif FILE_API == FILE_API_WIN32
+/*
+ *
+ *  Implementation of MappedFile using Win32 file mappings
+ *
+ */
+
+MappedFile::MappedFile()
+    : mOpen(false)
+    , mData(NULL)
+    , mSize(0)
+    , mFile(INVALID_HANDLE_VALUE)
+    , mMapping(NULL)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    if (mOpen)
+        close();
+}
+
+void MappedFile::open(const std::string& filename)
+{
+    assert(!mOpen);
+
+    std::wstring wname = boost::locale::conv::utf_to_utf<wchar_t>(filename);
+    mFile = CreateFileW(wname.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, 0, 0);
+    if (mFile == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Failed to open '" + filename + "' for reading.");
+
+    BY_HANDLE_FILE_INFORMATION info;
+    if (!GetFileInformationByHandle(mFile, &info))
+    {
+        CloseHandle(mFile);
+        mFile = INVALID_HANDLE_VALUE;
+        throw std::runtime_error("A query operation on '" + filename + "' failed.");
+    }
+
+    if (info.nFileSizeHigh != 0)
+    {
+        CloseHandle(mFile);
+        mFile = INVALID_HANDLE_VALUE;
+        throw std::runtime_error("Files greater that 4GB are not supported.");
+    }
+
+    mSize = info.nFileSizeLow;
+    if (mSize != 0)
+    {
+        mMapping = CreateFileMappingW(mFile, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mMapping != NULL)
+            mData = static_cast<const char*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+
+        if (mData == NULL)
+        {
+            if (mMapping != NULL)
+                CloseHandle(mMapping);
+            mMapping = NULL;
+            CloseHandle(mFile);
+            mFile = INVALID_HANDLE_VALUE;
+            mSize = 0;
+            throw std::runtime_error("Failed to map '" + filename + "' into memory.");
+        }
+    }
+
+    mOpen = true;
+}
+
+void MappedFile::close()
+{
+    assert(mOpen);
+
+    if (mData)
+        UnmapViewOfFile(mData);
+    if (mMapping != NULL)
+        CloseHandle(mMapping);
+    CloseHandle(mFile);
+
+    mData = NULL;
+    mSize = 0;
+    mMapping = NULL;
+    mFile = INVALID_HANDLE_VALUE;
+    mOpen = false;
+}
+
+#endif
+
+// ------------------------------------------------------------------------------
+
+MappedFileStream::MappedFileStream(MappedFilePtr file, size_t start, size_t length)
+    : MemBuf(file->data() + start, length)
+    , IMemStream(file->data() + start, length)
+    , mFile(file)
+{
+    assert(start + length <= file->size());
+}
+
+IStreamPtr openMappedFileStream(MappedFilePtr file, size_t start, size_t length)
+{
+    return IStreamPtr(new MappedFileStream(file, start, length));
+}
+
+}
@@ -0,0 +1,69 @@
+#ifndef COMPONENTS_FILES_MAPPEDFILE_HPP
+#define COMPONENTS_FILES_MAPPEDFILE_HPP
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "lowlevelfile.hpp"
+#include "memorystream.hpp"
+#include "constrainedfilestream.hpp"
+
+namespace Files
+{
+
+    /// @brief A read-only mapping of an entire file into memory.
+    /// @par Uses mmap() / MapViewOfFile() where available. On other platforms the file is read into
+    /// memory in one go, so the interface stays the same.
+    /// @note Reading from data() is thread safe.
+    class MappedFile
+    {
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        /// @note Throws an exception if the file can not be opened or mapped.
+        void open(const std::string& filename);
+        void close();
+
+        bool isOpen() const { return mOpen; }
+
+        const char* data() const { return mData; }
+        size_t size() const { return mSize; }
+
+    private:
+        // not implemented
+        MappedFile(const MappedFile&);
+        MappedFile& operator=(const MappedFile&);
+
+        bool mOpen;
+        const char* mData;
+        size_t mSize;
+
+#if FILE_API == FILE_API_WIN32
+        HANDLE mFile;
+        HANDLE mMapping;
+#elif FILE_API == FILE_API_STDIO
+        std::vector<char> mBuffer;
+#endif
+    };
+
+    typedef boost::shared_ptr<MappedFile> MappedFilePtr;
+
+    /// @brief A zero-copy stream over a region of a MappedFile.
+    /// @note Keeps the mapping alive for as long as the stream exists.
+    class MappedFileStream : public IMemStream
+    {
+    public:
+        MappedFileStream(MappedFilePtr file, size_t start, size_t length);
+
+    private:
+        MappedFilePtr mFile;
+    };
+
+    IStreamPtr openMappedFileStream(MappedFilePtr file, size_t start, size_t length);
+
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef INTERPRETER_DISPATCHTABLE_H_INCLUDED
+#define INTERPRETER_DISPATCHTABLE_H_INCLUDED
+
+#include <map>
+#include <vector>
+
+namespace Interpreter
+{
+    /// \brief Dense lookup table from opcode to handler
+    ///
+    /// Opcodes within a segment are clustered into a few contiguous ranges (the core
+    /// instructions at the bottom of the segment and the extensions further up), so
+    /// they are stored as a short list of arrays, each covering one range.
+    template<typename T>
+    class DispatchTable
+    {
+            struct Block
+            {
+                int mBase;
+                std::vector<T *> mOpcodes;
+            };
+
+            std::vector<Block> mBlocks;
+
+            /// Start a new block if two installed opcodes are further apart than this.
+            static const int sMaxGap = 256;
+
+        public:
+
+            void build (const std::map<int, T *>& opcodes)
+            ///< Rebuild the table from all installed opcodes.
+            {
+                mBlocks.clear();
+
+                for (typename std::map<int, T *>::const_iterator iter (opcodes.begin());
+                    iter!=opcodes.end(); ++iter)
+                {
+                    if (mBlocks.empty() ||
+                        iter->first - (mBlocks.back().mBase + static_cast<int> (mBlocks.back().mOpcodes.size())) > sMaxGap)
+                    {
+                        mBlocks.push_back (Block());
+                        mBlocks.back().mBase = iter->first;
+                    }
+
+                    Block& block = mBlocks.back();
+                    block.mOpcodes.resize (iter->first - block.mBase + 1, 0);
+                    block.mOpcodes.back() = iter->second;
+                }
+            }
+
+            T *find (int code) const
+            ///< \return 0, if no opcode has been installed for \a code.
+            {
+                for (typename std::vector<Block>::const_iterator iter (mBlocks.begin());
+                    iter!=mBlocks.end(); ++iter)
+                {
+                    unsigned int index = static_cast<unsigned int> (code - iter->mBase);
+
+                    if (index<iter->mOpcodes.size())
+                        return iter->mOpcodes[index];
+                }
+
+                return 0;
+            }
+    };
+}
+
+#endif
@@ -6,6 +6,7 @@
 
 #include "runtime.hpp"
 #include "types.hpp"
+#include "dispatchtable.hpp"
 
 namespace Interpreter
 {
@@ -25,10 +26,21 @@ namespace Interpreter
             std::map<int, Opcode2 *> mSegment4;
             std::map<int, Opcode0 *> mSegment5;
 
+            // compiled from mSegment0..5 before running, if opcodes have been installed since
+            bool mDispatchDirty;
+            DispatchTable<Opcode1> mDispatch0;
+            DispatchTable<Opcode2> mDispatch1;
+            DispatchTable<Opcode1> mDispatch2;
+            DispatchTable<Opcode1> mDispatch3;
+            DispatchTable<Opcode2> mDispatch4;
+            DispatchTable<Opcode0> mDispatch5;
+
             // not implemented
             Interpreter (const Interpreter&);
             Interpreter& operator= (const Interpreter&);
 
+            void buildDispatchTables();
+
             void execute (Type_Code code);
 
             void abortUnknownCode (int segment, int opcode);
@@ -183,9 +183,7 @@ void NiPixelData::read(NIFStream *nif)
 
     // Read the data
     unsigned int dataSize = nif->getInt();
-    data.reserve(dataSize);
-    for (unsigned i=0; i<dataSize; ++i)
-        data.push_back((unsigned char)nif->getChar());
+    nif->getUChars(data, dataSize);
 }
 
 void NiColorData::read(NIFStream *nif)
@@ -6,7 +6,8 @@
 #include "nifstream.hpp"
 
 #include <sstream>
-#include <map>
+#include <vector>
+#include <algorithm>
 
 #include <boost/shared_ptr.hpp>
 
@@ -15,30 +16,9 @@
 namespace Nif
 {
 
-template<typename T>
-struct KeyT {
-    T mValue;
-
-    // FIXME: Implement Quadratic and TBC interpolation
-    /*
-    T mForwardValue;  // Only for Quadratic interpolation, and never for QuaternionKeyList
-    T mBackwardValue; // Only for Quadratic interpolation, and never for QuaternionKeyList
-    float mTension;    // Only for TBC interpolation
-    float mBias;       // Only for TBC interpolation
-    float mContinuity; // Only for TBC interpolation
-    */
-};
-typedef KeyT<float> FloatKey;
-typedef KeyT<osg::Vec3f> Vector3Key;
-typedef KeyT<osg::Vec4f> Vector4Key;
-typedef KeyT<osg::Quat> QuaternionKey;
-
 template<typename T, T (NIFStream::*getValue)()>
 struct KeyMapT {
-    typedef std::map< float, KeyT<T> > MapType;
-
     typedef T ValueType;
-    typedef KeyT<T> KeyType;
 
     static const unsigned int sLinearInterpolation = 1;
     static const unsigned int sQuadraticInterpolation = 2;
@@ -46,10 +26,26 @@ struct KeyMapT {
     static const unsigned int sXYZInterpolation = 4;
 
     unsigned int mInterpolationType;
-    MapType mKeys;
+
+    // The keys, sorted by time and without duplicate times. Kept as two flat arrays,
+    // so that searching for a time only touches the times.
+    std::vector<float> mTimes;
+    std::vector<T> mValues;
+
+    // FIXME: Implement Quadratic and TBC interpolation
+    /*
+    T mForwardValue;  // Only for Quadratic interpolation, and never for QuaternionKeyList
+    T mBackwardValue; // Only for Quadratic interpolation, and never for QuaternionKeyList
+    float mTension;    // Only for TBC interpolation
+    float mBias;       // Only for TBC interpolation
+    float mContinuity; // Only for TBC interpolation
+    */
 
     KeyMapT() : mInterpolationType(sLinearInterpolation) {}
 
+    bool empty() const { return mTimes.empty(); }
+    size_t size() const { return mTimes.size(); }
+
     //Read in a KeyGroup (see http://niftools.sourceforge.net/doc/nif/NiKeyframeData.html)
     void read(NIFStream *nif, bool force=false)
     {
@@ -61,38 +57,41 @@ struct KeyMapT {
         if(count == 0 && !force)
             return;
 
-        mKeys.clear();
+        mTimes.clear();
+        mValues.clear();
 
         mInterpolationType = nif->getUInt();
 
-        KeyT<T> key;
         NIFStream &nifReference = *nif;
 
         if(mInterpolationType == sLinearInterpolation)
         {
+            mTimes.reserve(count);
+            mValues.reserve(count);
             for(size_t i = 0;i < count;i++)
             {
-                float time = nif->getFloat();
-                readValue(nifReference, key);
-                mKeys[time] = key;
+                mTimes.push_back(nif->getFloat());
+                mValues.push_back(readValue(nifReference));
             }
         }
         else if(mInterpolationType == sQuadraticInterpolation)
         {
+            mTimes.reserve(count);
+            mValues.reserve(count);
             for(size_t i = 0;i < count;i++)
             {
-                float time = nif->getFloat();
-                readQuadratic(nifReference, key);
-                mKeys[time] = key;
+                mTimes.push_back(nif->getFloat());
+                mValues.push_back(readQuadratic(nifReference, static_cast<T*>(NULL)));
             }
         }
         else if(mInterpolationType == sTBCInterpolation)
         {
+            mTimes.reserve(count);
+            mValues.reserve(count);
             for(size_t i = 0;i < count;i++)
             {
-                float time = nif->getFloat();
-                readTBC(nifReference, key);
-                mKeys[time] = key;
+                mTimes.push_back(nif->getFloat());
+                mValues.push_back(readTBC(nifReference));
             }
         }
         //XYZ keys aren't actually read here.
@@ -122,33 +121,78 @@ struct KeyMapT {
             error << "Unhandled interpolation type: " << mInterpolationType;
             nif->file->fail(error.str());
         }
+
+        sortKeys();
     }
 
 private:
-    static void readValue(NIFStream &nif, KeyT<T> &key)
+    struct CompareTimes
+    {
+        const std::vector<float>* mTimes;
+        bool operator()(size_t a, size_t b) const { return (*mTimes)[a] < (*mTimes)[b]; }
+    };
+
+    /// Keys are normally stored in order already. If they are not, sort them, and for duplicate
+    /// times keep the last key in the file.
+    void sortKeys()
+    {
+        bool sorted = true;
+        for (size_t i = 1; i < mTimes.size() && sorted; i++)
+            sorted = mTimes[i-1] < mTimes[i];
+        if (sorted)
+            return;
+
+        std::vector<size_t> order(mTimes.size());
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = i;
+        CompareTimes compare;
+        compare.mTimes = &mTimes;
+        std::stable_sort(order.begin(), order.end(), compare);
+
+        std::vector<float> times;
+        std::vector<T> values;
+        times.reserve(order.size());
+        values.reserve(order.size());
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            if (!times.empty() && times.back() == mTimes[order[i]])
+                values.back() = mValues[order[i]];
+            else
+            {
+                times.push_back(mTimes[order[i]]);
+                values.push_back(mValues[order[i]]);
+            }
+        }
+        mTimes.swap(times);
+        mValues.swap(values);
+    }
+
+    static T readValue(NIFStream &nif)
     {
-        key.mValue = (nif.*getValue)();
+        return (nif.*getValue)();
     }
 
     template <typename U>
-    static void readQuadratic(NIFStream &nif, KeyT<U> &key)
+    static T readQuadratic(NIFStream &nif, U*)
     {
-        readValue(nif, key);
-        /*key.mForwardValue = */(nif.*getValue)();
-        /*key.mBackwardValue = */(nif.*getValue)();
+        T value = readValue(nif);
+        /*mForwardValue = */(nif.*getValue)();
+        /*mBackwardValue = */(nif.*getValue)();
+        return value;
     }
 
-    static void readQuadratic(NIFStream &nif, KeyT<osg::Quat> &key)
+    static T readQuadratic(NIFStream &nif, osg::Quat*)
     {
-        readValue(nif, key);
+        return readValue(nif);
     }
 
-    static void readTBC(NIFStream &nif, KeyT<T> &key)
+    static T readTBC(NIFStream &nif)
     {
-        readValue(nif, key);
-        /*key.mTension = */nif.getFloat();
-        /*key.mBias = */nif.getFloat();
-        /*key.mContinuity = */nif.getFloat();
+        T value = readValue(nif);
+        /*mTension = */nif.getFloat();
+        /*mBias = */nif.getFloat();
+        /*mContinuity = */nif.getFloat();
+        return value;
     }
 };
 typedef KeyMapT<float,&NIFStream::getFloat> FloatKeyMap;
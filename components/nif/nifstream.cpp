@@ -2,6 +2,10 @@
 //For error reporting
 #include "niffile.hpp"
 
+#include <algorithm>
+
+#include <osg/Endian>
+
 namespace Nif
 {
 
@@ -32,6 +36,20 @@ float NIFStream::read_le32f()
     } u = { read_le32() };
     return u.f;
 }
+void NIFStream::read_le_array(void* dest, size_t count, size_t size)
+{
+    if (count == 0)
+        return;
+
+    char* bytes = static_cast<char*>(dest);
+    inp->read(bytes, count * size);
+
+    if (osg::getCpuByteOrder() == osg::BigEndian && size > 1)
+    {
+        for (size_t i = 0; i < count; i++)
+            std::reverse(bytes + i*size, bytes + (i+1)*size);
+    }
+}
 
 //Public functions
 osg::Vec2f NIFStream::getVector2()
@@ -103,41 +121,55 @@ std::string NIFStream::getVersionString()
     return result;
 }
 
+void NIFStream::getUChars(std::vector<unsigned char> &vec, size_t size)
+{
+    vec.resize(size);
+    if (size)
+        inp->read(reinterpret_cast<char*>(&vec[0]), size);
+}
 void NIFStream::getUShorts(osg::VectorGLushort* vec, size_t size)
 {
-    vec->reserve(size);
-    for(size_t i = 0;i < size;i++)
-        vec->push_back(getUShort());
+    size_t offset = vec->size();
+    vec->resize(offset + size);
+    if (size)
+        read_le_array(&(*vec)[offset], size, sizeof(GLushort));
 }
 void NIFStream::getFloats(std::vector<float> &vec, size_t size)
 {
     vec.resize(size);
-    for(size_t i = 0;i < vec.size();i++)
-        vec[i] = getFloat();
+    if (size)
+        read_le_array(&vec[0], size, sizeof(float));
 }
 void NIFStream::getVector2s(osg::Vec2Array* vec, size_t size)
 {
-    vec->reserve(size);
-    for(size_t i = 0;i < size;i++)
-        vec->push_back(getVector2());
+    size_t offset = vec->size();
+    vec->resize(offset + size);
+    if (size)
+        read_le_array((*vec)[offset].ptr(), size * 2, sizeof(float));
 }
 void NIFStream::getVector3s(osg::Vec3Array* vec, size_t size)
 {
-    vec->reserve(size);
-    for(size_t i = 0;i < size;i++)
-        vec->push_back(getVector3());
+    size_t offset = vec->size();
+    vec->resize(offset + size);
+    if (size)
+        read_le_array((*vec)[offset].ptr(), size * 3, sizeof(float));
 }
 void NIFStream::getVector4s(osg::Vec4Array* vec, size_t size)
 {
-    vec->reserve(size);
-    for(size_t i = 0;i < size;i++)
-        vec->push_back(getVector4());
+    size_t offset = vec->size();
+    vec->resize(offset + size);
+    if (size)
+        read_le_array((*vec)[offset].ptr(), size * 4, sizeof(float));
 }
 void NIFStream::getQuaternions(std::vector<osg::Quat> &quat, size_t size)
 {
+    // osg::Quat holds doubles in x, y, z, w order, while the file has floats in w, x, y, z order
+    std::vector<float> values;
+    getFloats(values, size * 4);
+
     quat.resize(size);
     for(size_t i = 0;i < quat.size();i++)
-        quat[i] = getQuaternion();
+        quat[i].set(values[i*4+1], values[i*4+2], values[i*4+3], values[i*4]);
 }
 
 }
@@ -33,6 +33,10 @@ class NIFStream {
     uint32_t read_le32();
     float read_le32f();
 
+    /// Read an array of count little endian values of the given size in one go, swapping their bytes
+    /// in place if this is a big endian machine.
+    void read_le_array(void* dest, size_t count, size_t size);
+
 public:
 
     NIFFile * const file;
@@ -62,6 +66,7 @@ public:
     ///This is special since the version string doesn't start with a number, and ends with "\n"
     std::string getVersionString();
 
+    void getUChars(std::vector<unsigned char> &vec, size_t size);
     void getUShorts(osg::VectorGLushort* vec, size_t size);
     void getFloats(std::vector<float> &vec, size_t size);
     void getVector2s(osg::Vec2Array* vec, size_t size);
@@ -69,6 +69,8 @@ float ControllerFunction::getMaximum() const
 }
 
 KeyframeController::KeyframeController()
+    : mScalesShareRotationTimes(false)
+    , mTranslationsShareRotationTimes(false)
 {
 }
 
@@ -81,6 +83,8 @@ KeyframeController::KeyframeController(const KeyframeController &copy, const osg
     , mZRotations(copy.mZRotations)
     , mTranslations(copy.mTranslations)
     , mScales(copy.mScales)
+    , mScalesShareRotationTimes(copy.mScalesShareRotationTimes)
+    , mTranslationsShareRotationTimes(copy.mTranslationsShareRotationTimes)
 {
 }
 
@@ -92,6 +96,8 @@ KeyframeController::KeyframeController(const Nif::NiKeyframeData *data)
     , mTranslations(data->mTranslations, osg::Vec3f())
     , mScales(data->mScales, 1.f)
 {
+    mScalesShareRotationTimes = mRotations.hasSameKeyTimes(mScales);
+    mTranslationsShareRotationTimes = mRotations.hasSameKeyTimes(mTranslations);
 }
 
 osg::Quat KeyframeController::getXYZRotation(float time) const
@@ -128,10 +134,15 @@ void KeyframeController::operator() (osg::Node* node, osg::NodeVisitor* nv)
         NodeUserData* userdata = static_cast<NodeUserData*>(trans->getUserDataContainer()->getUserObject(0));
         Nif::Matrix3& rot = userdata->mRotationScale;
 
+        KeySample sample = KeySample();
+        bool haveSample = false;
+
         bool setRot = false;
         if(!mRotations.empty())
         {
-            mat.setRotate(mRotations.interpKey(time));
+            sample = mRotations.sample(time);
+            haveSample = true;
+            mat.setRotate(mRotations.interpKey(sample));
             setRot = true;
         }
         else if (!mXRotations.empty() || !mYRotations.empty() || !mZRotations.empty())
@@ -153,14 +164,18 @@ void KeyframeController::operator() (osg::Node* node, osg::NodeVisitor* nv)
                     rot.mValues[i][j] = mat(j,i); // NB column/row major difference
 
         float& scale = userdata->mScale;
-        if(!mScales.empty())
+        if(haveSample && mScalesShareRotationTimes)
+            scale = mScales.interpKey(sample);
+        else if(!mScales.empty())
             scale = mScales.interpKey(time);
 
         for (int i=0;i<3;++i)
             for (int j=0;j<3;++j)
                 mat(i,j) *= scale;
 
-        if(!mTranslations.empty())
+        if(haveSample && mTranslationsShareRotationTimes)
+            mat.setTrans(mTranslations.interpKey(sample));
+        else if(!mTranslations.empty())
             mat.setTrans(mTranslations.interpKey(time));
 
         trans->setMatrix(mat);
@@ -12,6 +12,8 @@
 #include <boost/shared_ptr.hpp>
 
 #include <set> //UVController
+#include <vector>
+#include <algorithm>
 
 // FlipController
 #include <osg/Texture2D>
@@ -41,6 +43,14 @@ namespace osgAnimation
 namespace NifOsg
 {
 
+    /// A position on a keyframe track: interpolate between key mIndex and key mIndex+1 by mFraction.
+    /// A sample can be reused by any interpolator whose keys have the same times (see ValueInterpolator::hasSameKeyTimes).
+    struct KeySample
+    {
+        size_t mIndex;
+        float mFraction;
+    };
+
     // interpolation of keyframes
     template <typename MapT, typename InterpolationFunc>
     class ValueInterpolator
@@ -49,81 +59,95 @@ namespace NifOsg
         typedef typename MapT::ValueType ValueT;
 
         ValueInterpolator()
-            : mDefaultVal(ValueT())
+            : mLastHighKey(0)
+            , mDefaultVal(ValueT())
         {
         }
 
         ValueInterpolator(boost::shared_ptr<const MapT> keys, ValueT defaultVal = ValueT())
-            : mKeys(keys)
+            : mLastHighKey(0)
+            , mKeys(keys)
             , mDefaultVal(defaultVal)
         {
-            if (keys)
-            {
-                mLastLowKey = mKeys->mKeys.end();
-                mLastHighKey = mKeys->mKeys.end();
-            }
         }
 
-        ValueT interpKey(float time) const
+        /// @note Must not be called when empty().
+        KeySample sample(float time) const
         {
-            if (empty())
-                return mDefaultVal;
+            const std::vector<float>& times = mKeys->mTimes;
 
-            const typename MapT::MapType & keys = mKeys->mKeys;
+            KeySample result;
+            result.mFraction = 0.f;
 
-            if(time <= keys.begin()->first)
-                return keys.begin()->second.mValue;
+            if(time <= times.front())
+            {
+                result.mIndex = 0;
+                return result;
+            }
+            if(time >= times.back())
+            {
+                result.mIndex = times.size()-1;
+                return result;
+            }
 
-            // retrieve the current position in the map, optimized for the most common case
+            // retrieve the current position on the track, optimized for the most common case
             // where time moves linearly along the keyframe track
-            typename MapT::MapType::const_iterator it = mLastHighKey;
-            if (mLastHighKey != keys.end())
+            size_t high = mLastHighKey;
+            if (high == 0 || high >= times.size() || time <= times[high-1] || time > times[high])
             {
-                if (time > mLastHighKey->first)
+                // try if we're there by incrementing one
+                ++high;
+                if (high == 0 || high >= times.size() || time <= times[high-1] || time > times[high])
                 {
-                    // try if we're there by incrementing one
-                    ++mLastLowKey;
-                    ++mLastHighKey;
-                    it = mLastHighKey;
+                    // still not there, reorient by performing a binary search on the whole track
+                    high = std::lower_bound(times.begin(), times.end(), time) - times.begin();
                 }
-                if (mLastHighKey == keys.end() || (time < mLastLowKey->first || time > mLastHighKey->first))
-                    it = keys.lower_bound(time); // still not there, reorient by performing lower_bound check on the whole map
             }
-            else
-                it = keys.lower_bound(time);
+            mLastHighKey = high;
 
-            // now do the actual interpolation
-            if (it != keys.end())
-            {
-                float aTime = it->first;
-                const typename MapT::KeyType* aKey = &it->second;
+            result.mIndex = high-1;
+            result.mFraction = (time - times[high-1]) / (times[high] - times[high-1]);
+            return result;
+        }
 
-                // cache for next time
-                mLastHighKey = it;
+        /// @note Must not be called when empty().
+        ValueT interpKey(const KeySample& sample) const
+        {
+            const std::vector<ValueT>& values = mKeys->mValues;
+            if (sample.mFraction == 0.f)
+                return values[sample.mIndex];
+            return InterpolationFunc()(values[sample.mIndex], values[sample.mIndex+1], sample.mFraction);
+        }
 
-                assert (it != keys.begin()); // Shouldn't happen, was checked at beginning of this function
+        ValueT interpKey(float time) const
+        {
+            if (empty())
+                return mDefaultVal;
 
-                typename MapT::MapType::const_iterator last = --it;
-                mLastLowKey = last;
-                float aLastTime = last->first;
-                const typename MapT::KeyType* aLastKey = &last->second;
+            return interpKey(sample(time));
+        }
 
-                float a = (time - aLastTime) / (aTime - aLastTime);
+        bool empty() const
+        {
+            return !mKeys || mKeys->empty();
+        }
 
-                return InterpolationFunc()(aLastKey->mValue, aKey->mValue, a);
-            }
-            else
-                return keys.rbegin()->second.mValue;
+        template <typename OtherInterpolator>
+        bool hasSameKeyTimes(const OtherInterpolator& other) const
+        {
+            if (empty() || other.empty())
+                return false;
+            return mKeys->mTimes == other.getKeyTimes();
         }
 
-        bool empty() const
+        /// @note Must not be called when empty().
+        const std::vector<float>& getKeyTimes() const
         {
-            return !mKeys || mKeys->mKeys.empty();
+            return mKeys->mTimes;
         }
 
     private:
-        mutable typename MapT::MapType::const_iterator mLastLowKey;
-        mutable typename MapT::MapType::const_iterator mLastHighKey;
+        mutable size_t mLastHighKey;
 
         boost::shared_ptr<const MapT> mKeys;
 
@@ -215,6 +239,11 @@ namespace NifOsg
         Vec3Interpolator mTranslations;
         FloatInterpolator mScales;
 
+        // Most tracks key rotation, scale and translation at the same times, in which case the
+        // position on the rotation track is looked up once and reused for the others.
+        bool mScalesShareRotationTimes;
+        bool mTranslationsShareRotationTimes;
+
         osg::Quat getXYZRotation(float time) const;
     };
 
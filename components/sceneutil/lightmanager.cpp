@@ -1,9 +1,13 @@
 #include "lightmanager.hpp"
 
 #include <stdexcept>
+#include <algorithm>
+#include <cmath>
 
 #include <osg/NodeVisitor>
 #include <osg/Geode>
+#include <osg/Polytope>
+#include <osg/Math>
 
 #include <osgUtil/CullVisitor>
 
@@ -226,14 +230,25 @@ namespace SceneUtil
         return mLights;
     }
 
-    const std::vector<LightManager::LightSourceViewBound>& LightManager::getLightsInViewSpace(osg::Camera *camera, const osg::RefMatrix* viewMatrix)
+    const LightManager::ViewSpaceLights& LightManager::getLightsInViewSpace(osg::Camera *camera, const osg::RefMatrix* viewMatrix)
     {
         osg::observer_ptr<osg::Camera> camPtr (camera);
-        std::map<osg::observer_ptr<osg::Camera>, LightSourceViewBoundCollection>::iterator it = mLightsInViewSpace.find(camPtr);
+        std::map<osg::observer_ptr<osg::Camera>, ViewSpaceLights>::iterator it = mLightsInViewSpace.find(camPtr);
 
         if (it == mLightsInViewSpace.end())
         {
-            it = mLightsInViewSpace.insert(std::make_pair(camPtr, LightSourceViewBoundCollection())).first;
+            it = mLightsInViewSpace.insert(std::make_pair(camPtr, ViewSpaceLights())).first;
+
+            // A relative camera's projection is applied on top of its parent's, e.g. the water cameras don't set one
+            // at all and are left with the identity. Culling against that would throw away most of their lights.
+            const bool cull = (camera->getReferenceFrame() == osg::Transform::ABSOLUTE_RF);
+
+            osg::Polytope frustum;
+            if (cull)
+            {
+                frustum.setToUnitFrustum(false, false);
+                frustum.transformProvidingInverse(camera->getProjectionMatrix());
+            }
 
             for (std::vector<LightSourceTransform>::iterator lightIt = mLights.begin(); lightIt != mLights.end(); ++lightIt)
             {
@@ -241,15 +256,147 @@ namespace SceneUtil
                 osg::BoundingSphere viewBound = osg::BoundingSphere(osg::Vec3f(0,0,0), lightIt->mLightSource->getRadius());
                 transformBoundingSphere(worldViewMat, viewBound);
 
+                if (cull && !frustum.contains(viewBound))
+                    continue;
+
                 LightSourceViewBound l;
                 l.mLightSource = lightIt->mLightSource;
                 l.mViewBound = viewBound;
-                it->second.push_back(l);
+                it->second.mLights.push_back(l);
             }
+
+            it->second.buildGrid();
         }
         return it->second;
     }
 
+    // With fewer lights than this, testing every light is faster than using the grid
+    static const unsigned int sMinLightsForGrid = 16;
+
+    // Maximum number of grid cells along each axis
+    static const int sMaxGridSize = 16;
+
+    LightManager::ViewSpaceLights::ViewSpaceLights()
+        : mQueryCount(0)
+    {
+        for (int i=0; i<3; ++i)
+            mGridSize[i] = 0;
+    }
+
+    void LightManager::ViewSpaceLights::buildGrid()
+    {
+        mCellStart.clear();
+        mCellLights.clear();
+        mGridBounds.init();
+        if (mLights.size() < sMinLightsForGrid)
+            return;
+
+        for (std::vector<LightSourceViewBound>::const_iterator it = mLights.begin(); it != mLights.end(); ++it)
+            mGridBounds.expandBy(it->mViewBound);
+
+        // aim for roughly one light per cell
+        int size = std::min(sMaxGridSize, static_cast<int>(std::ceil(std::pow(static_cast<float>(mLights.size()), 1.f/3.f))));
+        for (int i=0; i<3; ++i)
+        {
+            float extent = mGridBounds._max[i] - mGridBounds._min[i];
+            mGridSize[i] = extent > 0 ? size : 1;
+            mInvCellSize[i] = extent > 0 ? size / extent : 0.f;
+        }
+
+        // count the lights of each cell, then fill in the light indices
+        std::vector<int> begin (mLights.size() * 3);
+        std::vector<int> end (mLights.size() * 3);
+        mCellStart.resize(mGridSize[0] * mGridSize[1] * mGridSize[2] + 1, 0);
+        for (unsigned int i=0; i<mLights.size(); ++i)
+        {
+            getCellRange(osg::BoundingBox(mLights[i].mViewBound.center() - osg::Vec3f(1,1,1) * mLights[i].mViewBound.radius(),
+                                          mLights[i].mViewBound.center() + osg::Vec3f(1,1,1) * mLights[i].mViewBound.radius()),
+                         &begin[i*3], &end[i*3]);
+            for (int x=begin[i*3]; x<end[i*3]; ++x)
+                for (int y=begin[i*3+1]; y<end[i*3+1]; ++y)
+                    for (int z=begin[i*3+2]; z<end[i*3+2]; ++z)
+                        ++mCellStart[(x * mGridSize[1] + y) * mGridSize[2] + z + 1];
+        }
+
+        for (unsigned int i=1; i<mCellStart.size(); ++i)
+            mCellStart[i] += mCellStart[i-1];
+
+        std::vector<unsigned int> fill (mCellStart.begin(), mCellStart.end()-1);
+        mCellLights.resize(mCellStart.back());
+        for (unsigned int i=0; i<mLights.size(); ++i)
+        {
+            for (int x=begin[i*3]; x<end[i*3]; ++x)
+                for (int y=begin[i*3+1]; y<end[i*3+1]; ++y)
+                    for (int z=begin[i*3+2]; z<end[i*3+2]; ++z)
+                        mCellLights[fill[(x * mGridSize[1] + y) * mGridSize[2] + z]++] = i;
+        }
+
+        mVisited.assign(mLights.size(), 0);
+        mQueryCount = 0;
+    }
+
+    void LightManager::ViewSpaceLights::getCellRange(const osg::BoundingBox &box, int begin[], int end[]) const
+    {
+        for (int i=0; i<3; ++i)
+        {
+            begin[i] = osg::clampBetween(static_cast<int>((box._min[i] - mGridBounds._min[i]) * mInvCellSize[i]), 0, mGridSize[i]-1);
+            end[i] = osg::clampBetween(static_cast<int>((box._max[i] - mGridBounds._min[i]) * mInvCellSize[i]), 0, mGridSize[i]-1) + 1;
+        }
+    }
+
+    void LightManager::ViewSpaceLights::findIntersecting(const osg::BoundingSphere &viewBound, LightList &lightList) const
+    {
+        if (mCellStart.empty())
+        {
+            for (unsigned int i=0; i<mLights.size(); ++i)
+            {
+                if (mLights[i].mViewBound.intersects(viewBound))
+                    lightList.push_back(&mLights[i]);
+            }
+            return;
+        }
+
+        if (!viewBound.valid())
+            return;
+
+        osg::BoundingBox box (viewBound.center() - osg::Vec3f(1,1,1) * viewBound.radius(),
+                              viewBound.center() + osg::Vec3f(1,1,1) * viewBound.radius());
+        if (!box.intersects(mGridBounds))
+            return;
+
+        if (++mQueryCount == 0)
+        {
+            // wrapped around, forget the old marks
+            mVisited.assign(mVisited.size(), 0);
+            mQueryCount = 1;
+        }
+
+        int begin[3], end[3];
+        getCellRange(box, begin, end);
+
+        mFound.clear();
+        for (int x=begin[0]; x<end[0]; ++x)
+            for (int y=begin[1]; y<end[1]; ++y)
+                for (int z=begin[2]; z<end[2]; ++z)
+                {
+                    int cell = (x * mGridSize[1] + y) * mGridSize[2] + z;
+                    for (unsigned int i=mCellStart[cell]; i<mCellStart[cell+1]; ++i)
+                    {
+                        unsigned int light = mCellLights[i];
+                        if (mVisited[light] == mQueryCount)
+                            continue;
+                        mVisited[light] = mQueryCount;
+                        if (mLights[light].mViewBound.intersects(viewBound))
+                            mFound.push_back(light);
+                    }
+                }
+
+        // keep the order of the lights, so the light list StateSets can be shared between objects
+        std::sort(mFound.begin(), mFound.end());
+        for (unsigned int i=0; i<mFound.size(); ++i)
+            lightList.push_back(&mLights[mFound[i]]);
+    }
+
     void LightManager::setStartLight(int start)
     {
         mStartLight = start;
@@ -316,11 +463,6 @@ namespace SceneUtil
             return;
         }
 
-        // Possible optimizations:
-        // - cull list of lights by the camera frustum
-        // - organize lights in a quad tree
-
-
         // update light list if necessary
         // makes sure we don't update it more than once per frame when rendering with multiple cameras
         if (mLastFrameNumber != nv->getTraversalNumber())
@@ -329,7 +471,7 @@ namespace SceneUtil
 
             // Don't use Camera::getViewMatrix, that one might be relative to another camera!
             const osg::RefMatrix* viewMatrix = cv->getCurrentRenderStage()->getInitialViewMatrix();
-            const std::vector<LightManager::LightSourceViewBound>& lights = mLightManager->getLightsInViewSpace(cv->getCurrentCamera(), viewMatrix);
+            const LightManager::ViewSpaceLights& lights = mLightManager->getLightsInViewSpace(cv->getCurrentCamera(), viewMatrix);
 
             // get the node bounds in view space
             // NB do not node->getBound() * modelView, that would apply the node's transformation twice
@@ -344,12 +486,7 @@ namespace SceneUtil
             transformBoundingSphere(mat, nodeBound);
 
             mLightList.clear();
-            for (unsigned int i=0; i<lights.size(); ++i)
-            {
-                const LightManager::LightSourceViewBound& l = lights[i];
-                if (l.mViewBound.intersects(nodeBound))
-                    mLightList.push_back(&l);
-            }
+            lights.findIntersecting(nodeBound, mLightList);
         }
         if (!mLightList.empty())
         {
@@ -116,18 +116,59 @@ namespace SceneUtil
             osg::BoundingSphere mViewBound;
         };
 
-        const std::vector<LightSourceViewBound>& getLightsInViewSpace(osg::Camera* camera, const osg::RefMatrix* viewMatrix);
-
         typedef std::vector<const LightSourceViewBound*> LightList;
 
+        /// @brief The lights collected this frame, transformed into the view space of one camera.
+        /// @par Indexed by a uniform grid over the light bounds, so that finding the lights for an object
+        /// does not have to test every light in the scene.
+        class ViewSpaceLights
+        {
+        public:
+            ViewSpaceLights();
+
+            const std::vector<LightSourceViewBound>& getLights() const { return mLights; }
+
+            /// Add the lights that intersect the given view space bound to \a lightList, in the order of getLights().
+            void findIntersecting(const osg::BoundingSphere& viewBound, LightList& lightList) const;
+
+        private:
+            friend class LightManager;
+
+            void buildGrid();
+
+            void getCellRange(const osg::BoundingBox& box, int begin[3], int end[3]) const;
+
+            std::vector<LightSourceViewBound> mLights;
+
+            osg::BoundingBox mGridBounds;
+            int mGridSize[3];
+            osg::Vec3f mInvCellSize;
+            // the lights overlapping cell i are mCellLights[mCellStart[i]] to mCellLights[mCellStart[i+1]-1]
+            std::vector<unsigned int> mCellStart;
+            std::vector<unsigned int> mCellLights;
+
+            // for skipping lights that overlap more than one cell
+            mutable std::vector<unsigned int> mVisited;
+            mutable unsigned int mQueryCount;
+            mutable std::vector<unsigned int> mFound;
+        };
+
+        /// Get the lights in view space for the given camera, computing them if this is the camera's first request in this frame.
+        /// @note Lights outside of the camera's view frustum are left out, since they can not light anything that is visible.
+        /// The near and far planes are ignored for this, as the near and far values may still be computed during the cull traversal.
+        /// The camera's own projection is used rather than the cull visitor's current one, since subgraphs may push
+        /// a different field of view (e.g. first person meshes) and the result is shared by the whole camera.
+        /// Cameras with a RELATIVE_RF reference frame (e.g. the water reflection and refraction cameras) don't hold a
+        /// complete projection of their own, so their lights are not culled at all.
+        const ViewSpaceLights& getLightsInViewSpace(osg::Camera* camera, const osg::RefMatrix* viewMatrix);
+
         osg::ref_ptr<osg::StateSet> getLightListStateSet(const LightList& lightList, unsigned int frameNum);
 
     private:
         // Lights collected from the scene graph. Only valid during the cull traversal.
         std::vector<LightSourceTransform> mLights;
 
-        typedef std::vector<LightSourceViewBound> LightSourceViewBoundCollection;
-        std::map<osg::observer_ptr<osg::Camera>, LightSourceViewBoundCollection> mLightsInViewSpace;
+        std::map<osg::observer_ptr<osg::Camera>, ViewSpaceLights> mLightsInViewSpace;
 
         // < Light list hash , StateSet >
         typedef std::map<size_t, osg::ref_ptr<osg::StateSet> > LightStateSetMap;
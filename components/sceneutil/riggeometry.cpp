@@ -8,6 +8,7 @@
 
 #include "skeleton.hpp"
 #include "util.hpp"
+#include "workqueue.hpp"
 
 namespace SceneUtil
 {
@@ -57,6 +58,24 @@ public:
     }
 };
 
+class SkinningWorkItem : public WorkItem
+{
+public:
+    SkinningWorkItem(RigGeometry* rig)
+        : mRig(rig)
+    {
+    }
+
+    virtual void doWork()
+    {
+        mRig->skin();
+    }
+
+private:
+    // Not a ref_ptr, the RigGeometry holds on to its work item and waits for it before being destroyed.
+    RigGeometry* mRig;
+};
+
 // We can't compute the bounds without a NodeVisitor, since we need the current geomToSkelMatrix.
 // So we return nothing. Bounds are updated every frame in the UpdateCallback.
 class DummyComputeBoundCallback : public osg::Drawable::ComputeBoundingBoxCallback
@@ -86,6 +105,19 @@ RigGeometry::RigGeometry(const RigGeometry &copy, const osg::CopyOp &copyop)
     setSourceGeometry(copy.mSourceGeometry);
 }
 
+RigGeometry::~RigGeometry()
+{
+    if (mSkinningItem)
+        mSkinningItem->waitTillDone();
+}
+
+WorkQueue* RigGeometry::sSkinningWorkQueue = NULL;
+
+void RigGeometry::setSkinningWorkQueue(WorkQueue *workQueue)
+{
+    sSkinningWorkQueue = workQueue;
+}
+
 void RigGeometry::setSourceGeometry(osg::ref_ptr<osg::Geometry> sourceGeometry)
 {
     mSourceGeometry = sourceGeometry;
@@ -176,9 +208,31 @@ bool RigGeometry::initFromParentSkeleton(osg::NodeVisitor* nv)
         }
     }
 
+    typedef std::map<std::vector<BoneWeight>, std::vector<unsigned short> > Bone2VertexMap;
+    Bone2VertexMap bone2VertexMap;
     for (Vertex2BoneMap::iterator it = vertex2BoneMap.begin(); it != vertex2BoneMap.end(); ++it)
     {
-        mBone2VertexMap[it->second].push_back(it->first);
+        bone2VertexMap[it->second].push_back(it->first);
+    }
+
+    // copy the source vertices into the order they are skinned in
+    const osg::Vec3Array* positionSrc = static_cast<osg::Vec3Array*>(mSourceGeometry->getVertexArray());
+    const osg::Vec3Array* normalSrc = static_cast<osg::Vec3Array*>(mSourceGeometry->getNormalArray());
+
+    mBoneWeightGroups.clear();
+    mSkinningVertices.clear();
+    for (Bone2VertexMap::const_iterator it = bone2VertexMap.begin(); it != bone2VertexMap.end(); ++it)
+    {
+        BoneWeightGroup group;
+        group.mWeights = it->first;
+        group.mBegin = mSkinningVertices.size();
+        for (std::vector<unsigned short>::const_iterator vertexIt = it->second.begin(); vertexIt != it->second.end(); ++vertexIt)
+        {
+            unsigned short vertex = *vertexIt;
+            mSkinningVertices.push_back((*positionSrc)[vertex], (*normalSrc)[vertex], vertex);
+        }
+        group.mEnd = mSkinningVertices.size();
+        mBoneWeightGroups.push_back(group);
     }
 
     return true;
@@ -225,21 +279,23 @@ void RigGeometry::update(osg::NodeVisitor* nv)
 
     mSkeleton->updateBoneMatrices(nv);
 
-    // skinning
-    osg::Vec3Array* positionSrc = static_cast<osg::Vec3Array*>(mSourceGeometry->getVertexArray());
-    osg::Vec3Array* normalSrc = static_cast<osg::Vec3Array*>(mSourceGeometry->getNormalArray());
-
-    osg::Vec3Array* positionDst = static_cast<osg::Vec3Array*>(getVertexArray());
-    osg::Vec3Array* normalDst = static_cast<osg::Vec3Array*>(getNormalArray());
+    // the draw of this copy waits for the skinning, but make sure in case it was culled and then not drawn
+    if (mSkinningItem)
+    {
+        mSkinningItem->waitTillDone();
+        mSkinningItem = NULL;
+    }
 
-    for (Bone2VertexMap::const_iterator it = mBone2VertexMap.begin(); it != mBone2VertexMap.end(); ++it)
+    mGroupMatrices.resize(mBoneWeightGroups.size());
+    for (size_t i=0; i<mBoneWeightGroups.size(); ++i)
     {
         osg::Matrixf resultMat  (0, 0, 0, 0,
                                 0, 0, 0, 0,
                                 0, 0, 0, 0,
                                 0, 0, 0, 1);
 
-        for (std::vector<BoneWeight>::const_iterator weightIt = it->first.begin(); weightIt != it->first.end(); ++weightIt)
+        const std::vector<BoneWeight>& weights = mBoneWeightGroups[i].mWeights;
+        for (std::vector<BoneWeight>::const_iterator weightIt = weights.begin(); weightIt != weights.end(); ++weightIt)
         {
             Bone* bone = weightIt->first.first;
             const osg::Matrix& invBindMatrix = weightIt->first.second;
@@ -247,18 +303,42 @@ void RigGeometry::update(osg::NodeVisitor* nv)
             const osg::Matrixf& boneMatrix = bone->mMatrixInSkeletonSpace;
             accumulateMatrix(invBindMatrix, boneMatrix, weight, resultMat);
         }
-        resultMat = resultMat * mGeomToSkelMatrix;
+        mGroupMatrices[i] = resultMat * mGeomToSkelMatrix;
+    }
 
-        for (std::vector<unsigned short>::const_iterator vertexIt = it->second.begin(); vertexIt != it->second.end(); ++vertexIt)
-        {
-            unsigned short vertex = *vertexIt;
-            (*positionDst)[vertex] = resultMat.preMult((*positionSrc)[vertex]);
-            (*normalDst)[vertex] = osg::Matrix::transform3x3((*normalSrc)[vertex], resultMat);
-        }
+    if (sSkinningWorkQueue)
+    {
+        mSkinningItem = new SkinningWorkItem(this);
+        sSkinningWorkQueue->addWorkItem(mSkinningItem, WorkQueue::Priority_High);
     }
+    else
+        skin();
+
+    getVertexArray()->dirty();
+    getNormalArray()->dirty();
+}
+
+void RigGeometry::skin()
+{
+    if (mSkinningVertices.size() == 0)
+        return;
+
+    osg::Vec3Array* positionDst = static_cast<osg::Vec3Array*>(getVertexArray());
+    osg::Vec3Array* normalDst = static_cast<osg::Vec3Array*>(getNormalArray());
+
+    for (size_t i=0; i<mBoneWeightGroups.size(); ++i)
+    {
+        const BoneWeightGroup& group = mBoneWeightGroups[i];
+        skinVertices(mGroupMatrices[i], mSkinningVertices, group.mBegin, group.mEnd, &(*positionDst)[0], &(*normalDst)[0]);
+    }
+}
+
+void RigGeometry::drawImplementation(osg::RenderInfo &renderInfo) const
+{
+    if (mSkinningItem)
+        mSkinningItem->waitTillDone();
 
-    positionDst->dirty();
-    normalDst->dirty();
+    osg::Geometry::drawImplementation(renderInfo);
 }
 
 void RigGeometry::updateBounds(osg::NodeVisitor *nv)
@@ -4,11 +4,15 @@
 #include <osg/Geometry>
 #include <osg/Matrixf>
 
+#include "skinning.hpp"
+
 namespace SceneUtil
 {
 
     class Skeleton;
     class Bone;
+    class WorkQueue;
+    class WorkItem;
 
     /// @brief Mesh skinning implementation.
     /// @note A RigGeometry may be attached directly to a Skeleton, or somewhere below a Skeleton.
@@ -18,6 +22,7 @@ namespace SceneUtil
     public:
         RigGeometry();
         RigGeometry(const RigGeometry& copy, const osg::CopyOp& copyop);
+        ~RigGeometry();
 
         META_Object(SceneUtil, RigGeometry)
 
@@ -44,6 +49,19 @@ namespace SceneUtil
         // Called automatically by our UpdateCallback
         void updateBounds(osg::NodeVisitor* nv);
 
+        /// Waits for the skinning of this frame to complete, if it was handed to the skinning work queue.
+        virtual void drawImplementation(osg::RenderInfo& renderInfo) const;
+
+        /// Skin the vertices on the given work queue rather than in the cull traversal. The cull traversal then
+        /// only computes the bone matrices and carries on, while the draw of each RigGeometry waits for its own skinning.
+        /// @note Relies on the frame-alternating copies that the NIF loader creates for each RigGeometry, so that
+        /// the copy being drawn is never the copy being skinned.
+        /// @par The caller keeps ownership of the work queue and must reset it to NULL before destroying it.
+        static void setSkinningWorkQueue(WorkQueue* workQueue);
+
+        /// Transform the vertices by the bone matrices computed in the last update. Used internally by the skinning work item.
+        void skin();
+
     private:
         osg::ref_ptr<osg::Geometry> mSourceGeometry;
         Skeleton* mSkeleton;
@@ -57,11 +75,24 @@ namespace SceneUtil
 
         typedef std::pair<BoneBindMatrixPair, float> BoneWeight;
 
-        typedef std::vector<unsigned short> VertexList;
+        /// Vertices that share the same bone weights, i.e. the range [mBegin, mEnd) in mSkinningVertices.
+        struct BoneWeightGroup
+        {
+            std::vector<BoneWeight> mWeights;
+            size_t mBegin;
+            size_t mEnd;
+        };
+
+        std::vector<BoneWeightGroup> mBoneWeightGroups;
+
+        /// The skinning matrix of each BoneWeightGroup for the current frame.
+        std::vector<osg::Matrixf> mGroupMatrices;
+
+        osg::ref_ptr<WorkItem> mSkinningItem;
 
-        typedef std::map<std::vector<BoneWeight>, VertexList> Bone2VertexMap;
+        static WorkQueue* sSkinningWorkQueue;
 
-        Bone2VertexMap mBone2VertexMap;
+        SkinningVertices mSkinningVertices;
 
         typedef std::map<Bone*, osg::BoundingSpheref> BoneSphereMap;
 
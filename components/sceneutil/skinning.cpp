@@ -0,0 +1,115 @@
+#include "skinning.hpp"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define OPENMW_SSE_SKINNING
+#include <xmmintrin.h>
+#endif
+
+namespace SceneUtil
+{
+
+void SkinningVertices::clear()
+{
+    mX.clear();
+    mY.clear();
+    mZ.clear();
+    mNormalX.clear();
+    mNormalY.clear();
+    mNormalZ.clear();
+    mIndices.clear();
+}
+
+void SkinningVertices::push_back(const osg::Vec3f &position, const osg::Vec3f &normal, unsigned short index)
+{
+    mX.push_back(position.x());
+    mY.push_back(position.y());
+    mZ.push_back(position.z());
+    mNormalX.push_back(normal.x());
+    mNormalY.push_back(normal.y());
+    mNormalZ.push_back(normal.z());
+    mIndices.push_back(index);
+}
+
+void skinVerticesScalar(const osg::Matrixf& matrix, const SkinningVertices& src, size_t begin, size_t end,
+                        osg::Vec3f* positionDst, osg::Vec3f* normalDst)
+{
+    // same as osg::Matrixf::preMult and osg::Matrixf::transform3x3, for an affine matrix
+    const float* m = matrix.ptr();
+    for (size_t i=begin; i<end; ++i)
+    {
+        float x = src.mX[i], y = src.mY[i], z = src.mZ[i];
+        float nx = src.mNormalX[i], ny = src.mNormalY[i], nz = src.mNormalZ[i];
+        unsigned short index = src.mIndices[i];
+
+        positionDst[index].set(m[0]*x + m[4]*y + m[8]*z + m[12],
+                               m[1]*x + m[5]*y + m[9]*z + m[13],
+                               m[2]*x + m[6]*y + m[10]*z + m[14]);
+        normalDst[index].set(m[0]*nx + m[4]*ny + m[8]*nz,
+                             m[1]*nx + m[5]*ny + m[9]*nz,
+                             m[2]*nx + m[6]*ny + m[10]*nz);
+    }
+}
+
+#ifdef OPENMW_SSE_SKINNING
+
+void skinVertices(const osg::Matrixf& matrix, const SkinningVertices& src, size_t begin, size_t end,
+                  osg::Vec3f* positionDst, osg::Vec3f* normalDst)
+{
+    const float* m = matrix.ptr();
+    const __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]);
+    const __m128 m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]), m6 = _mm_set1_ps(m[6]);
+    const __m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]), m10 = _mm_set1_ps(m[10]);
+    const __m128 m12 = _mm_set1_ps(m[12]), m13 = _mm_set1_ps(m[13]), m14 = _mm_set1_ps(m[14]);
+
+    float px[4], py[4], pz[4], nx[4], ny[4], nz[4];
+
+    size_t i = begin;
+    for (; i+4 <= end; i+=4)
+    {
+        __m128 x = _mm_loadu_ps(&src.mX[i]);
+        __m128 y = _mm_loadu_ps(&src.mY[i]);
+        __m128 z = _mm_loadu_ps(&src.mZ[i]);
+        _mm_storeu_ps(px, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m4, y)), _mm_add_ps(_mm_mul_ps(m8, z), m12)));
+        _mm_storeu_ps(py, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, x), _mm_mul_ps(m5, y)), _mm_add_ps(_mm_mul_ps(m9, z), m13)));
+        _mm_storeu_ps(pz, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, x), _mm_mul_ps(m6, y)), _mm_add_ps(_mm_mul_ps(m10, z), m14)));
+
+        x = _mm_loadu_ps(&src.mNormalX[i]);
+        y = _mm_loadu_ps(&src.mNormalY[i]);
+        z = _mm_loadu_ps(&src.mNormalZ[i]);
+        _mm_storeu_ps(nx, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m4, y)), _mm_mul_ps(m8, z)));
+        _mm_storeu_ps(ny, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, x), _mm_mul_ps(m5, y)), _mm_mul_ps(m9, z)));
+        _mm_storeu_ps(nz, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, x), _mm_mul_ps(m6, y)), _mm_mul_ps(m10, z)));
+
+        // the primitive sets reference the original vertex order, so the results have to be scattered
+        for (int j=0; j<4; ++j)
+        {
+            unsigned short index = src.mIndices[i+j];
+            positionDst[index].set(px[j], py[j], pz[j]);
+            normalDst[index].set(nx[j], ny[j], nz[j]);
+        }
+    }
+
+    skinVerticesScalar(matrix, src, i, end, positionDst, normalDst);
+}
+
+bool hasSimdSkinning()
+{
+    return true;
+}
+
+#else
+
+void skinVertices(const osg::Matrixf& matrix, const SkinningVertices& src, size_t begin, size_t end,
+                  osg::Vec3f* positionDst, osg::Vec3f* normalDst)
+{
+    skinVerticesScalar(matrix, src, begin, end, positionDst, normalDst);
+}
+
+bool hasSimdSkinning()
+{
+    return false;
+}
+
+#endif
+
+}
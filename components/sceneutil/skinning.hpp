@@ -0,0 +1,45 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_SKINNING_H
+#define OPENMW_COMPONENTS_SCENEUTIL_SKINNING_H
+
+#include <vector>
+#include <cstddef>
+
+#include <osg/Matrixf>
+#include <osg/Vec3f>
+
+namespace SceneUtil
+{
+
+    /// @brief Source vertices of a skinned mesh in structure-of-arrays layout.
+    /// @note Vertices are sorted so that vertices influenced by the same bones with the same weights are contiguous,
+    /// and can be transformed by the same matrix in one go.
+    struct SkinningVertices
+    {
+        std::vector<float> mX, mY, mZ;
+        std::vector<float> mNormalX, mNormalY, mNormalZ;
+
+        /// Index of each vertex in the destination arrays.
+        std::vector<unsigned short> mIndices;
+
+        void clear();
+
+        void push_back(const osg::Vec3f& position, const osg::Vec3f& normal, unsigned short index);
+
+        size_t size() const { return mIndices.size(); }
+    };
+
+    /// Transform the vertices [begin, end) of src by an affine matrix, writing the positions and normals into the
+    /// destination arrays at each vertex's index. Uses SSE when available.
+    void skinVertices(const osg::Matrixf& matrix, const SkinningVertices& src, size_t begin, size_t end,
+                      osg::Vec3f* positionDst, osg::Vec3f* normalDst);
+
+    /// Reference implementation of skinVertices, without SIMD.
+    void skinVerticesScalar(const osg::Matrixf& matrix, const SkinningVertices& src, size_t begin, size_t end,
+                            osg::Vec3f* positionDst, osg::Vec3f* normalDst);
+
+    /// Does skinVertices use SIMD instructions in this build?
+    bool hasSimdSkinning();
+
+}
+
+#endif
@@ -40,7 +40,7 @@ namespace SceneUtil
         if (mWorkItem->mObjects.empty())
             return;
 
-        workQueue->addWorkItem(mWorkItem);
+        workQueue->addWorkItem(mWorkItem, SceneUtil::WorkQueue::Priority_Low);
 
         mWorkItem = new UnrefWorkItem;
     }
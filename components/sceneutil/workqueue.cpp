@@ -39,6 +39,30 @@ bool WorkItem::isDone() const
     return (mDone > 0);
 }
 
+void WorkItem::abort()
+{
+    mAborted.exchange(1);
+}
+
+bool WorkItem::isAborted() const
+{
+    return (mAborted > 0);
+}
+
+bool WorkItem::start()
+{
+    return (mStarted.exchange(1) == 0);
+}
+
+bool WorkItem::abortIfNotStarted()
+{
+    // claim the item first, so a worker thread can not start it between the check and the abort
+    if (mStarted.exchange(1) != 0)
+        return false;
+    abort();
+    return true;
+}
+
 WorkQueue::WorkQueue(int workerThreads)
     : mIsReleased(false)
 {
@@ -54,8 +78,17 @@ WorkQueue::~WorkQueue()
 {
     {
         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
-        while (!mQueue.empty())
-            mQueue.pop();
+        for (int priority=0; priority<NumPriorities; ++priority)
+        {
+            // nobody is going to run these anymore, don't leave anyone hanging in waitTillDone()
+            ItemQueue& queue = mItems[priority];
+            for (ItemQueue::iterator item = queue.begin(); item != queue.end(); ++item)
+            {
+                (*item)->abort();
+                (*item)->signalDone();
+            }
+            queue.clear();
+        }
         mIsReleased = true;
         mCondition.broadcast();
     }
@@ -67,7 +100,7 @@ WorkQueue::~WorkQueue()
     }
 }
 
-void WorkQueue::addWorkItem(osg::ref_ptr<WorkItem> item)
+void WorkQueue::addWorkItem(osg::ref_ptr<WorkItem> item, Priority priority)
 {
     if (item->isDone())
     {
@@ -76,25 +109,35 @@ void WorkQueue::addWorkItem(osg::ref_ptr<WorkItem> item)
     }
 
     OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
-    mQueue.push(item);
+    mItems[priority].push_back(item);
     mCondition.signal();
 }
 
 osg::ref_ptr<WorkItem> WorkQueue::removeWorkItem()
 {
     OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
-    while (mQueue.empty() && !mIsReleased)
+    while (!mIsReleased)
     {
+        for (int priority=0; priority<NumPriorities; ++priority)
+        {
+            ItemQueue& queue = mItems[priority];
+            while (!queue.empty())
+            {
+                osg::ref_ptr<WorkItem> item = queue.front();
+                queue.pop_front();
+
+                if (item->isAborted())
+                {
+                    item->signalDone();
+                    continue;
+                }
+                return item;
+            }
+        }
+
         mCondition.wait(&mMutex);
     }
-    if (!mQueue.empty())
-    {
-        osg::ref_ptr<WorkItem> item = mQueue.front();
-        mQueue.pop();
-        return item;
-    }
-    else
-        return NULL;
+    return NULL;
 }
 
 WorkThread::WorkThread(WorkQueue *workQueue)
@@ -109,7 +152,8 @@ void WorkThread::run()
         osg::ref_ptr<WorkItem> item = mWorkQueue->removeWorkItem();
         if (!item)
             return;
-        item->doWork();
+        if (!item->isAborted() && item->start())
+            item->doWork();
         item->signalDone();
     }
 }
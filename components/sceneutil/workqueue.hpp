@@ -9,7 +9,8 @@
 #include <osg/Referenced>
 #include <osg/ref_ptr>
 
-#include <queue>
+#include <deque>
+#include <vector>
 
 namespace SceneUtil
 {
@@ -31,8 +32,24 @@ namespace SceneUtil
         /// Internal use by the WorkQueue.
         void signalDone();
 
+        /// Internal use by the WorkThread. Claim the work item for running doWork().
+        /// @return false if the item was already claimed, i.e. by abortIfNotStarted().
+        bool start();
+
+        /// Cancel the work item. If no worker thread has started it yet, doWork() will be skipped.
+        /// @note The item is still signalled as done once a worker thread has dequeued it, so waitTillDone() remains usable.
+        void abort();
+
+        bool isAborted() const;
+
+        /// Cancel the work item, unless a worker thread has already started it.
+        /// @return Was the item cancelled? If not, it is running or done and will complete as usual.
+        bool abortIfNotStarted();
+
     protected:
         OpenThreads::Atomic mDone;
+        OpenThreads::Atomic mAborted;
+        OpenThreads::Atomic mStarted;
         OpenThreads::Mutex mMutex;
         OpenThreads::Condition mCondition;
     };
@@ -40,26 +57,39 @@ namespace SceneUtil
     class WorkThread;
 
     /// @brief A work queue that users can push work items onto, to be completed by one or more background threads.
-    /// @note Work items will be processed in the order that they were given in, however
+    /// @note There is one queue per priority. A work item is never started while an item of higher priority is waiting.
+    /// Items of the same priority are started in the order that they were given in, however
     /// if multiple work threads are involved then it is possible for a later item to complete before earlier items.
     class WorkQueue : public osg::Referenced
     {
     public:
+        enum Priority
+        {
+            Priority_High = 0, ///< Work the player is about to need, e.g. the cell being entered.
+            Priority_Normal = 1,
+            Priority_Low = 2, ///< Speculative work and maintenance, e.g. fast travel destinations or cache cleanup.
+
+            NumPriorities = 3
+        };
+
         WorkQueue(int numWorkerThreads=1);
         ~WorkQueue();
 
-        /// Add a new work item to the back of the queue.
+        /// Add a new work item to the back of the queue for the given priority.
         /// @par The work item's waitTillDone() method may be used by the caller to wait until the work is complete.
-        void addWorkItem(osg::ref_ptr<WorkItem> item);
+        void addWorkItem(osg::ref_ptr<WorkItem> item, Priority priority=Priority_Normal);
 
-        /// Get the next work item from the front of the queue. If the queue is empty, waits until a new item is added.
+        /// Get the next work item, preferring higher priorities. Aborted items are signalled as done and skipped.
+        /// If the queue is empty, waits until a new item is added.
         /// If the workqueue is in the process of being destroyed, may return NULL.
         /// @par Used internally by the WorkThread.
         osg::ref_ptr<WorkItem> removeWorkItem();
 
     private:
+        typedef std::deque<osg::ref_ptr<WorkItem> > ItemQueue;
+
         bool mIsReleased;
-        std::queue<osg::ref_ptr<WorkItem> > mQueue;
+        ItemQueue mItems[NumPriorities];
 
         OpenThreads::Mutex mMutex;
         OpenThreads::Condition mCondition;
@@ -1,6 +1,7 @@
 #include "terraingrid.hpp"
 
 #include <memory>
+#include <stdexcept>
 
 #include <osg/Material>
 
@@ -13,6 +14,7 @@
 #include <components/sceneutil/lightmanager.hpp>
 #include <components/sceneutil/positionattitudetransform.hpp>
 #include <components/sceneutil/unrefqueue.hpp>
+#include <components/sceneutil/workqueue.hpp>
 
 #include <components/esm/loadland.hpp>
 
@@ -50,7 +52,44 @@ namespace
 namespace Terrain
 {
 
-TerrainGrid::TerrainGrid(osg::Group* parent, Resource::ResourceSystem* resourceSystem, osgUtil::IncrementalCompileOperation* ico, Storage* storage, int nodeMask, Shader::ShaderManager* shaderManager, SceneUtil::UnrefQueue* unrefQueue)
+/// Builds one terrain chunk, to be attached to its parent by the thread building the cell.
+class TerrainGrid::BuildChunkWorkItem : public SceneUtil::WorkItem
+{
+public:
+    BuildChunkWorkItem(TerrainGrid* terrain, osg::Group* parent, float chunkSize, const osg::Vec2f& chunkCenter)
+        : mTerrain(terrain)
+        , mParent(parent)
+        , mChunkSize(chunkSize)
+        , mChunkCenter(chunkCenter)
+        , mFailed(false)
+    {
+    }
+
+    virtual void doWork()
+    {
+        try
+        {
+            mNode = mTerrain->buildChunk(mChunkSize, mChunkCenter);
+        }
+        catch (std::exception& e)
+        {
+            // rethrown on the thread building the cell
+            mFailed = true;
+            mError = e.what();
+        }
+    }
+
+    TerrainGrid* mTerrain;
+    osg::ref_ptr<osg::Group> mParent;
+    float mChunkSize;
+    osg::Vec2f mChunkCenter;
+
+    osg::ref_ptr<osg::Node> mNode;
+    bool mFailed;
+    std::string mError;
+};
+
+TerrainGrid::TerrainGrid(osg::Group* parent, Resource::ResourceSystem* resourceSystem, osgUtil::IncrementalCompileOperation* ico, Storage* storage, int nodeMask, Shader::ShaderManager* shaderManager, SceneUtil::UnrefQueue* unrefQueue, int numBuildThreads)
     : Terrain::World(parent, resourceSystem, ico, storage, nodeMask)
     , mNumSplits(4)
     , mCache((storage->getCellVertices()-1)/static_cast<float>(mNumSplits) + 1)
@@ -60,6 +99,9 @@ TerrainGrid::TerrainGrid(osg::Group* parent, Resource::ResourceSystem* resourceS
     osg::ref_ptr<osg::Material> material (new osg::Material);
     material->setColorMode(osg::Material::AMBIENT_AND_DIFFUSE);
     mTerrainRoot->getOrCreateStateSet()->setAttributeAndModes(material, osg::StateAttribute::ON);
+
+    if (numBuildThreads > 0)
+        mBuildQueue = new SceneUtil::WorkQueue(numBuildThreads);
 }
 
 TerrainGrid::~TerrainGrid()
@@ -78,14 +120,33 @@ osg::ref_ptr<osg::Node> TerrainGrid::cacheCell(int x, int y)
         if (found != mGridCache.end())
             return found->second;
     }
-    osg::ref_ptr<osg::Node> node = buildTerrain(NULL, 1.f, osg::Vec2f(x+0.5, y+0.5));
+    osg::ref_ptr<osg::Node> node = buildCell(osg::Vec2f(x+0.5, y+0.5));
 
     OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mGridCacheMutex);
     mGridCache.insert(std::make_pair(std::make_pair(x,y), node));
     return node;
 }
 
-osg::ref_ptr<osg::Node> TerrainGrid::buildTerrain (osg::Group* parent, float chunkSize, const osg::Vec2f& chunkCenter)
+osg::ref_ptr<osg::Node> TerrainGrid::buildCell(const osg::Vec2f& center)
+{
+    BuildChunkWorkItems chunks;
+    osg::ref_ptr<osg::Node> node = buildTerrain(NULL, 1.f, center, chunks);
+
+    // wait for all chunks before attaching any, so that no worker thread is left running if one of them failed
+    for (BuildChunkWorkItems::const_iterator it = chunks.begin(); it != chunks.end(); ++it)
+        (*it)->waitTillDone();
+
+    for (BuildChunkWorkItems::const_iterator it = chunks.begin(); it != chunks.end(); ++it)
+    {
+        if ((*it)->mFailed)
+            throw std::runtime_error((*it)->mError);
+        if ((*it)->mNode)
+            (*it)->mParent->addChild((*it)->mNode);
+    }
+    return node;
+}
+
+osg::ref_ptr<osg::Node> TerrainGrid::buildTerrain (osg::Group* parent, float chunkSize, const osg::Vec2f& chunkCenter, BuildChunkWorkItems& chunks)
 {
     if (chunkSize * mNumSplits > 1.f)
     {
@@ -95,144 +156,158 @@ osg::ref_ptr<osg::Node> TerrainGrid::buildTerrain (osg::Group* parent, float chu
             parent->addChild(group);
 
         float newChunkSize = chunkSize/2.f;
-        buildTerrain(group, newChunkSize, chunkCenter + osg::Vec2f(newChunkSize/2.f, newChunkSize/2.f));
-        buildTerrain(group, newChunkSize, chunkCenter + osg::Vec2f(newChunkSize/2.f, -newChunkSize/2.f));
-        buildTerrain(group, newChunkSize, chunkCenter + osg::Vec2f(-newChunkSize/2.f, newChunkSize/2.f));
-        buildTerrain(group, newChunkSize, chunkCenter + osg::Vec2f(-newChunkSize/2.f, -newChunkSize/2.f));
+        buildTerrain(group, newChunkSize, chunkCenter + osg::Vec2f(newChunkSize/2.f, newChunkSize/2.f), chunks);
+        buildTerrain(group, newChunkSize, chunkCenter + osg::Vec2f(newChunkSize/2.f, -newChunkSize/2.f), chunks);
+        buildTerrain(group, newChunkSize, chunkCenter + osg::Vec2f(-newChunkSize/2.f, newChunkSize/2.f), chunks);
+        buildTerrain(group, newChunkSize, chunkCenter + osg::Vec2f(-newChunkSize/2.f, -newChunkSize/2.f), chunks);
         return group;
     }
+    else if (!parent)
+        return buildChunk(chunkSize, chunkCenter);
     else
     {
-        float minH, maxH;
-        if (!mStorage->getMinMaxHeights(chunkSize, chunkCenter, minH, maxH))
-            return NULL; // no terrain defined
-
-        osg::Vec2f worldCenter = chunkCenter*mStorage->getCellWorldSize();
-        osg::ref_ptr<SceneUtil::PositionAttitudeTransform> transform (new SceneUtil::PositionAttitudeTransform);
-        transform->setPosition(osg::Vec3f(worldCenter.x(), worldCenter.y(), 0.f));
+        osg::ref_ptr<BuildChunkWorkItem> item (new BuildChunkWorkItem(this, parent, chunkSize, chunkCenter));
+        chunks.push_back(item);
+        // the thread building the cell is waiting for this, so use the highest priority
+        if (mBuildQueue)
+            mBuildQueue->addWorkItem(item, SceneUtil::WorkQueue::Priority_High);
+        else
+        {
+            item->doWork();
+            item->signalDone();
+        }
+        return NULL;
+    }
+}
 
-        if (parent)
-            parent->addChild(transform);
-
-        osg::ref_ptr<osg::Vec3Array> positions (new osg::Vec3Array);
-        osg::ref_ptr<osg::Vec3Array> normals (new osg::Vec3Array);
-        osg::ref_ptr<osg::Vec4Array> colors (new osg::Vec4Array);
-
-        osg::ref_ptr<osg::VertexBufferObject> vbo (new osg::VertexBufferObject);
-        positions->setVertexBufferObject(vbo);
-        normals->setVertexBufferObject(vbo);
-        colors->setVertexBufferObject(vbo);
-
-        mStorage->fillVertexBuffers(0, chunkSize, chunkCenter, positions, normals, colors);
-
-        osg::ref_ptr<osg::Geometry> geometry (new osg::Geometry);
-        geometry->setVertexArray(positions);
-        geometry->setNormalArray(normals, osg::Array::BIND_PER_VERTEX);
-        geometry->setColorArray(colors, osg::Array::BIND_PER_VERTEX);
-        geometry->setUseDisplayList(false);
-        geometry->setUseVertexBufferObjects(true);
-
-        geometry->addPrimitiveSet(mCache.getIndexBuffer(0));
-
-        // we already know the bounding box, so no need to let OSG compute it.
-        osg::Vec3f min(-0.5f*mStorage->getCellWorldSize()*chunkSize,
-                       -0.5f*mStorage->getCellWorldSize()*chunkSize,
-                       minH);
-        osg::Vec3f max (0.5f*mStorage->getCellWorldSize()*chunkSize,
-                           0.5f*mStorage->getCellWorldSize()*chunkSize,
-                           maxH);
-        osg::BoundingBox bounds(min, max);
-        geometry->setComputeBoundingBoxCallback(new StaticBoundingBoxCallback(bounds));
-
-        std::vector<LayerInfo> layerList;
-        std::vector<osg::ref_ptr<osg::Image> > blendmaps;
-        mStorage->getBlendmaps(chunkSize, chunkCenter, false, blendmaps, layerList);
-
-        // For compiling textures, I don't think the osgFX::Effect does it correctly
-        osg::ref_ptr<osg::Node> textureCompileDummy (new osg::Node);
-        unsigned int dummyTextureCounter = 0;
-
-        bool useShaders = mResourceSystem->getSceneManager()->getForceShaders();
-        if (!mResourceSystem->getSceneManager()->getClampLighting())
-            useShaders = true; // always use shaders when lighting is unclamped, this is to avoid lighting seams between a terrain chunk with normal maps and one without normal maps
-        std::vector<TextureLayer> layers;
+osg::ref_ptr<osg::Node> TerrainGrid::buildChunk(float chunkSize, const osg::Vec2f& chunkCenter)
+{
+    float minH, maxH;
+    if (!mStorage->getMinMaxHeights(chunkSize, chunkCenter, minH, maxH))
+        return NULL; // no terrain defined
+
+    osg::Vec2f worldCenter = chunkCenter*mStorage->getCellWorldSize();
+    osg::ref_ptr<SceneUtil::PositionAttitudeTransform> transform (new SceneUtil::PositionAttitudeTransform);
+    transform->setPosition(osg::Vec3f(worldCenter.x(), worldCenter.y(), 0.f));
+
+    osg::ref_ptr<osg::Vec3Array> positions (new osg::Vec3Array);
+    osg::ref_ptr<osg::Vec3Array> normals (new osg::Vec3Array);
+    osg::ref_ptr<osg::Vec4Array> colors (new osg::Vec4Array);
+
+    osg::ref_ptr<osg::VertexBufferObject> vbo (new osg::VertexBufferObject);
+    positions->setVertexBufferObject(vbo);
+    normals->setVertexBufferObject(vbo);
+    colors->setVertexBufferObject(vbo);
+
+    mStorage->fillVertexBuffers(0, chunkSize, chunkCenter, positions, normals, colors);
+
+    osg::ref_ptr<osg::Geometry> geometry (new osg::Geometry);
+    geometry->setVertexArray(positions);
+    geometry->setNormalArray(normals, osg::Array::BIND_PER_VERTEX);
+    geometry->setColorArray(colors, osg::Array::BIND_PER_VERTEX);
+    geometry->setUseDisplayList(false);
+    geometry->setUseVertexBufferObjects(true);
+
+    geometry->addPrimitiveSet(mCache.getIndexBuffer(0));
+
+    // we already know the bounding box, so no need to let OSG compute it.
+    osg::Vec3f min(-0.5f*mStorage->getCellWorldSize()*chunkSize,
+                   -0.5f*mStorage->getCellWorldSize()*chunkSize,
+                   minH);
+    osg::Vec3f max (0.5f*mStorage->getCellWorldSize()*chunkSize,
+                       0.5f*mStorage->getCellWorldSize()*chunkSize,
+                       maxH);
+    osg::BoundingBox bounds(min, max);
+    geometry->setComputeBoundingBoxCallback(new StaticBoundingBoxCallback(bounds));
+
+    std::vector<LayerInfo> layerList;
+    std::vector<osg::ref_ptr<osg::Image> > blendmaps;
+    mStorage->getBlendmaps(chunkSize, chunkCenter, false, blendmaps, layerList);
+
+    // For compiling textures, I don't think the osgFX::Effect does it correctly
+    osg::ref_ptr<osg::Node> textureCompileDummy (new osg::Node);
+    unsigned int dummyTextureCounter = 0;
+
+    bool useShaders = mResourceSystem->getSceneManager()->getForceShaders();
+    if (!mResourceSystem->getSceneManager()->getClampLighting())
+        useShaders = true; // always use shaders when lighting is unclamped, this is to avoid lighting seams between a terrain chunk with normal maps and one without normal maps
+    std::vector<TextureLayer> layers;
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mTextureCacheMutex);
+        for (std::vector<LayerInfo>::const_iterator it = layerList.begin(); it != layerList.end(); ++it)
         {
-            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mTextureCacheMutex);
-            for (std::vector<LayerInfo>::const_iterator it = layerList.begin(); it != layerList.end(); ++it)
+            TextureLayer textureLayer;
+            textureLayer.mSpecular = it->mSpecular;
+            osg::ref_ptr<osg::Texture2D> texture = mTextureCache[it->mDiffuseMap];
+            if (!texture)
             {
-                TextureLayer textureLayer;
-                textureLayer.mSpecular = it->mSpecular;
-                osg::ref_ptr<osg::Texture2D> texture = mTextureCache[it->mDiffuseMap];
+                texture = new osg::Texture2D(mResourceSystem->getImageManager()->getImage(it->mDiffuseMap));
+                texture->setWrap(osg::Texture::WRAP_S, osg::Texture::REPEAT);
+                texture->setWrap(osg::Texture::WRAP_T, osg::Texture::REPEAT);
+                mResourceSystem->getSceneManager()->applyFilterSettings(texture);
+                mTextureCache[it->mDiffuseMap] = texture;
+            }
+            textureLayer.mDiffuseMap = texture;
+            textureCompileDummy->getOrCreateStateSet()->setTextureAttributeAndModes(dummyTextureCounter++, texture);
+
+            if (!it->mNormalMap.empty())
+            {
+                texture = mTextureCache[it->mNormalMap];
                 if (!texture)
                 {
-                    texture = new osg::Texture2D(mResourceSystem->getImageManager()->getImage(it->mDiffuseMap));
+                    texture = new osg::Texture2D(mResourceSystem->getImageManager()->getImage(it->mNormalMap));
                     texture->setWrap(osg::Texture::WRAP_S, osg::Texture::REPEAT);
                     texture->setWrap(osg::Texture::WRAP_T, osg::Texture::REPEAT);
                     mResourceSystem->getSceneManager()->applyFilterSettings(texture);
-                    mTextureCache[it->mDiffuseMap] = texture;
+                    mTextureCache[it->mNormalMap] = texture;
                 }
-                textureLayer.mDiffuseMap = texture;
                 textureCompileDummy->getOrCreateStateSet()->setTextureAttributeAndModes(dummyTextureCounter++, texture);
-
-                if (!it->mNormalMap.empty())
-                {
-                    texture = mTextureCache[it->mNormalMap];
-                    if (!texture)
-                    {
-                        texture = new osg::Texture2D(mResourceSystem->getImageManager()->getImage(it->mNormalMap));
-                        texture->setWrap(osg::Texture::WRAP_S, osg::Texture::REPEAT);
-                        texture->setWrap(osg::Texture::WRAP_T, osg::Texture::REPEAT);
-                        mResourceSystem->getSceneManager()->applyFilterSettings(texture);
-                        mTextureCache[it->mNormalMap] = texture;
-                    }
-                    textureCompileDummy->getOrCreateStateSet()->setTextureAttributeAndModes(dummyTextureCounter++, texture);
-                    textureLayer.mNormalMap = texture;
-                }
-
-                if (it->requiresShaders())
-                    useShaders = true;
-
-                layers.push_back(textureLayer);
+                textureLayer.mNormalMap = texture;
             }
-        }
 
-        std::vector<osg::ref_ptr<osg::Texture2D> > blendmapTextures;
-        for (std::vector<osg::ref_ptr<osg::Image> >::const_iterator it = blendmaps.begin(); it != blendmaps.end(); ++it)
-        {
-            osg::ref_ptr<osg::Texture2D> texture (new osg::Texture2D);
-            texture->setImage(*it);
-            texture->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
-            texture->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
-            texture->setResizeNonPowerOfTwoHint(false);
-            blendmapTextures.push_back(texture);
-
-            textureCompileDummy->getOrCreateStateSet()->setTextureAttributeAndModes(dummyTextureCounter++, blendmapTextures.back());
+            if (it->requiresShaders())
+                useShaders = true;
+
+            layers.push_back(textureLayer);
         }
+    }
 
-        // use texture coordinates for both texture units, the layer texture and blend texture
-        for (unsigned int i=0; i<2; ++i)
-            geometry->setTexCoordArray(i, mCache.getUVBuffer());
+    std::vector<osg::ref_ptr<osg::Texture2D> > blendmapTextures;
+    for (std::vector<osg::ref_ptr<osg::Image> >::const_iterator it = blendmaps.begin(); it != blendmaps.end(); ++it)
+    {
+        osg::ref_ptr<osg::Texture2D> texture (new osg::Texture2D);
+        texture->setImage(*it);
+        texture->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
+        texture->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
+        texture->setResizeNonPowerOfTwoHint(false);
+        blendmapTextures.push_back(texture);
+
+        textureCompileDummy->getOrCreateStateSet()->setTextureAttributeAndModes(dummyTextureCounter++, blendmapTextures.back());
+    }
 
-        float blendmapScale = ESM::Land::LAND_TEXTURE_SIZE*chunkSize;
-        osg::ref_ptr<osgFX::Effect> effect (new Terrain::Effect(mShaderManager ? useShaders : false, mResourceSystem->getSceneManager()->getForcePerPixelLighting(), mResourceSystem->getSceneManager()->getClampLighting(),
-                                                                mShaderManager, layers, blendmapTextures, blendmapScale, blendmapScale));
+    // use texture coordinates for both texture units, the layer texture and blend texture
+    for (unsigned int i=0; i<2; ++i)
+        geometry->setTexCoordArray(i, mCache.getUVBuffer());
 
-        effect->addCullCallback(new SceneUtil::LightListCallback);
+    float blendmapScale = ESM::Land::LAND_TEXTURE_SIZE*chunkSize;
+    osg::ref_ptr<osgFX::Effect> effect (new Terrain::Effect(mShaderManager ? useShaders : false, mResourceSystem->getSceneManager()->getForcePerPixelLighting(), mResourceSystem->getSceneManager()->getClampLighting(),
+                                                            mShaderManager, layers, blendmapTextures, blendmapScale, blendmapScale));
 
-        transform->addChild(effect);
+    effect->addCullCallback(new SceneUtil::LightListCallback);
 
-        osg::Node* toAttach = geometry.get();
+    transform->addChild(effect);
 
-        effect->addChild(toAttach);
+    osg::Node* toAttach = geometry.get();
 
-        if (mIncrementalCompileOperation)
-        {
-            mIncrementalCompileOperation->add(toAttach);
-            mIncrementalCompileOperation->add(textureCompileDummy);
-        }
+    effect->addChild(toAttach);
 
-        return transform;
+    if (mIncrementalCompileOperation)
+    {
+        mIncrementalCompileOperation->add(toAttach);
+        mIncrementalCompileOperation->add(textureCompileDummy);
     }
+
+    return transform;
 }
 
 void TerrainGrid::loadCell(int x, int y)
@@ -257,7 +332,7 @@ void TerrainGrid::loadCell(int x, int y)
     if (!terrainNode)
     {
         osg::Vec2f center(x+0.5f, y+0.5f);
-        terrainNode = buildTerrain(NULL, 1.f, center);
+        terrainNode = buildCell(center);
         if (!terrainNode)
             return; // no terrain defined
     }
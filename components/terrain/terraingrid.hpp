@@ -1,6 +1,8 @@
 #ifndef COMPONENTS_TERRAIN_TERRAINGRID_H
 #define COMPONENTS_TERRAIN_TERRAINGRID_H
 
+#include <vector>
+
 #include <osg/Vec2f>
 
 #include "world.hpp"
@@ -8,6 +10,7 @@
 namespace SceneUtil
 {
     class UnrefQueue;
+    class WorkQueue;
 }
 
 namespace Shader
@@ -27,7 +30,8 @@ namespace Terrain
     class TerrainGrid : public Terrain::World
     {
     public:
-        TerrainGrid(osg::Group* parent, Resource::ResourceSystem* resourceSystem, osgUtil::IncrementalCompileOperation* ico, Storage* storage, int nodeMask, Shader::ShaderManager* shaderManager = NULL, SceneUtil::UnrefQueue* unrefQueue = NULL);
+        /// @param numBuildThreads Number of worker threads building the terrain chunks of a cell in parallel. With 0, chunks are built on the thread loading the cell.
+        TerrainGrid(osg::Group* parent, Resource::ResourceSystem* resourceSystem, osgUtil::IncrementalCompileOperation* ico, Storage* storage, int nodeMask, Shader::ShaderManager* shaderManager = NULL, SceneUtil::UnrefQueue* unrefQueue = NULL, int numBuildThreads = 0);
         ~TerrainGrid();
 
         /// Load a terrain cell and store it in cache for later use.
@@ -50,7 +54,17 @@ namespace Terrain
         void updateTextureFiltering();
 
     private:
-        osg::ref_ptr<osg::Node> buildTerrain (osg::Group* parent, float chunkSize, const osg::Vec2f& chunkCenter);
+        class BuildChunkWorkItem;
+        typedef std::vector<osg::ref_ptr<BuildChunkWorkItem> > BuildChunkWorkItems;
+
+        /// Build the terrain of a cell, building its chunks on the build queue if there is one.
+        osg::ref_ptr<osg::Node> buildCell (const osg::Vec2f& center);
+
+        /// Split the given area into chunks, adding a work item for each chunk to \a chunks.
+        osg::ref_ptr<osg::Node> buildTerrain (osg::Group* parent, float chunkSize, const osg::Vec2f& chunkCenter, BuildChunkWorkItems& chunks);
+
+        /// @note Thread safe.
+        osg::ref_ptr<osg::Node> buildChunk (float chunkSize, const osg::Vec2f& chunkCenter);
 
         // split each ESM::Cell into mNumSplits*mNumSplits terrain chunks
         unsigned int mNumSplits;
@@ -70,6 +84,8 @@ namespace Terrain
         osg::ref_ptr<SceneUtil::UnrefQueue> mUnrefQueue;
 
         Shader::ShaderManager* mShaderManager;
+
+        osg::ref_ptr<SceneUtil::WorkQueue> mBuildQueue;
     };
 
 }
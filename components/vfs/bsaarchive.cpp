@@ -6,7 +6,7 @@ namespace VFS
 
 BsaArchive::BsaArchive(const std::string &filename)
 {
-    mFile.open(filename);
+    mFile.open(filename, true);
 
     const Bsa::BSAFile::FileList &filelist = mFile.getList();
     for(Bsa::BSAFile::FileList::const_iterator it = filelist.begin();it != filelist.end();++it)
@@ -26,6 +26,62 @@ namespace
         std::transform(path.begin(), path.end(), path.begin(), normalize_char);
     }
 
+    struct IdentityChar
+    {
+        char operator()(char ch) const { return ch; }
+    };
+
+    struct StrictNormalizeChar
+    {
+        char operator()(char ch) const { return strict_normalize_char(ch); }
+    };
+
+    struct NonstrictNormalizeChar
+    {
+        char operator()(char ch) const { return nonstrict_normalize_char(ch); }
+    };
+
+    /// FNV-1a hash of a file name, normalized on the fly
+    template <class Normalize>
+    inline uint32_t hash_path(const char* path, size_t length, Normalize normalize_char)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i=0; i<length; ++i)
+        {
+            hash ^= static_cast<unsigned char>(normalize_char(path[i]));
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    template <class Entry, class Normalize>
+    inline VFS::File* lookup_path(const std::vector<Entry>& table, const std::vector<char>& names,
+                                  const char* path, size_t length, Normalize normalize_char)
+    {
+        if (table.empty())
+            return NULL;
+
+        const uint32_t hash = hash_path(path, length, normalize_char);
+        const size_t mask = table.size()-1;
+        for (size_t slot = hash & mask; table[slot].mFile; slot = (slot+1) & mask)
+        {
+            const Entry& entry = table[slot];
+            if (entry.mHash != hash || entry.mLength != length)
+                continue;
+
+            const char* key = &names[entry.mNameOffset];
+            size_t i=0;
+            for (; i<length; ++i)
+            {
+                if (key[i] != normalize_char(path[i]))
+                    break;
+            }
+            if (i == length)
+                return entry.mFile;
+        }
+        return NULL;
+    }
+
 }
 
 namespace VFS
@@ -55,30 +111,81 @@ namespace VFS
 
         for (std::vector<Archive*>::const_iterator it = mArchives.begin(); it != mArchives.end(); ++it)
             (*it)->listResources(mIndex, mStrict ? &strict_normalize_char : &nonstrict_normalize_char);
+
+        // Keep the load factor at or below 1/2
+        size_t tableSize = 16;
+        while (tableSize < mIndex.size()*2)
+            tableSize *= 2;
+
+        LookupEntry empty;
+        empty.mHash = 0;
+        empty.mLength = 0;
+        empty.mNameOffset = 0;
+        empty.mFile = NULL;
+        mLookup.assign(tableSize, empty);
+        mLookupNames.clear();
+
+        const size_t mask = tableSize-1;
+        for (std::map<std::string, File*>::const_iterator it = mIndex.begin(); it != mIndex.end(); ++it)
+        {
+            // Keys of mIndex are unique and already normalized
+            uint32_t hash = hash_path(it->first.c_str(), it->first.size(), IdentityChar());
+            size_t slot = hash & mask;
+            while (mLookup[slot].mFile)
+                slot = (slot+1) & mask;
+
+            LookupEntry& entry = mLookup[slot];
+            entry.mHash = hash;
+            entry.mLength = it->first.size();
+            entry.mNameOffset = mLookupNames.size();
+            entry.mFile = it->second;
+            mLookupNames.insert(mLookupNames.end(), it->first.begin(), it->first.end());
+        }
     }
 
-    Files::IStreamPtr Manager::get(const std::string &name) const
+    File* Manager::lookup(const char *name, size_t length, bool normalize) const
     {
-        std::string normalized = name;
-        normalize_path(normalized, mStrict);
+        if (!normalize)
+            return lookup_path(mLookup, mLookupNames, name, length, IdentityChar());
+        else if (mStrict)
+            return lookup_path(mLookup, mLookupNames, name, length, StrictNormalizeChar());
+        else
+            return lookup_path(mLookup, mLookupNames, name, length, NonstrictNormalizeChar());
+    }
 
-        return getNormalized(normalized);
+    Files::IStreamPtr Manager::get(const std::string &name) const
+    {
+        File* file = lookup(name.c_str(), name.size(), true);
+        if (!file)
+        {
+            std::string normalized = name;
+            normalize_path(normalized, mStrict);
+            throw std::runtime_error("Resource '" + normalized + "' not found");
+        }
+        return file->open();
     }
 
     Files::IStreamPtr Manager::getNormalized(const std::string &normalizedName) const
     {
-        std::map<std::string, File*>::const_iterator found = mIndex.find(normalizedName);
-        if (found == mIndex.end())
-            throw std::runtime_error("Resource '" + normalizedName + "' not found");
-        return found->second->open();
+        return getNormalized(normalizedName.c_str(), normalizedName.size());
+    }
+
+    Files::IStreamPtr Manager::getNormalized(const char *normalizedName, size_t length) const
+    {
+        File* file = lookup(normalizedName, length, false);
+        if (!file)
+            throw std::runtime_error("Resource '" + std::string(normalizedName, length) + "' not found");
+        return file->open();
     }
 
     bool Manager::exists(const std::string &name) const
     {
-        std::string normalized = name;
-        normalize_path(normalized, mStrict);
+        return lookup(name.c_str(), name.size(), true) != NULL;
+    }
 
-        return mIndex.find(normalized) != mIndex.end();
+    bool Manager::existsNormalized(const char *normalizedName, size_t length) const
+    {
+        return lookup(normalizedName, length, false) != NULL;
     }
 
     const std::map<std::string, File*>& Manager::getIndex() const
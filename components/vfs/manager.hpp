@@ -3,6 +3,7 @@
 
 #include <components/files/constrainedfilestream.hpp>
 
+#include <stdint.h>
 #include <vector>
 #include <map>
 
@@ -37,6 +38,11 @@ namespace VFS
         /// @note May be called from any thread once the index has been built.
         bool exists(const std::string& name) const;
 
+        /// Does a file with this name exist? (name is already normalized)
+        /// @note Does not allocate.
+        /// @note May be called from any thread once the index has been built.
+        bool existsNormalized(const char* normalizedName, size_t length) const;
+
         /// Get a complete list of files from all archives
         /// @note May be called from any thread once the index has been built.
         const std::map<std::string, File*>& getIndex() const;
@@ -55,12 +61,37 @@ namespace VFS
         /// @note May be called from any thread once the index has been built.
         Files::IStreamPtr getNormalized(const std::string& normalizedName) const;
 
+        /// Retrieve a file by name (name is already normalized, and does not need to be null-terminated).
+        /// @note Does not allocate, other than for the returned stream.
+        /// @note Throws an exception if the file can not be found.
+        /// @note May be called from any thread once the index has been built.
+        Files::IStreamPtr getNormalized(const char* normalizedName, size_t length) const;
+
     private:
+        /// Find a file in the hashed index, or return NULL if it doesn't exist.
+        /// @param normalize Normalize the given name on the fly?
+        File* lookup(const char* name, size_t length, bool normalize) const;
+
         bool mStrict;
 
         std::vector<Archive*> mArchives;
 
         std::map<std::string, File*> mIndex;
+
+        struct LookupEntry
+        {
+            uint32_t mHash;
+            uint32_t mLength;
+            size_t mNameOffset;
+            File* mFile;
+        };
+
+        /// Open addressing hash table over mIndex, used for lookups by name.
+        /// The size is always a power of two, empty slots have a NULL mFile.
+        std::vector<LookupEntry> mLookup;
+
+        /// The normalized names of all files, packed back to back for mLookup.
+        std::vector<char> mLookupNames;
     };
 
 }